@@ -12,6 +12,10 @@
 // ヘッダファイルをインクルードする。
 #include "AmpEnvelope.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace {
 const float AMP_MAX = 1.0f;
 const float AMP_MIN = 0.0f;
@@ -33,6 +37,7 @@ AmpEnvelope::AmpEnvelope(float attackTime, float decayTime, float sustain,
       _timer(0.0f),
       _ampState(AMPENV_STATE::WAIT) {
   checkVarRange();
+  updateIncrements();
 }
 
 AmpEnvelope::~AmpEnvelope() {}
@@ -51,6 +56,27 @@ void AmpEnvelope::setParameters(float attackTime, float decayTime,
   _echoTime = echoTime;
 
   checkVarRange();
+  updateIncrements();
+}
+
+void AmpEnvelope::setSampleRate(float sampleRate) {
+  if (_sampleRate != sampleRate) {
+    _sampleRate = sampleRate;
+    updateIncrements();
+  }
+}
+
+// 各区間でタイマーを0から1まで進める1サンプルあたりの増分
+void AmpEnvelope::updateIncrements() {
+  if (_sampleRate <= 0.0f) {
+    _attackIncrement = _decayIncrement = _releaseIncrement = _echoIncrement = 0.0f;
+    return;
+  }
+  _attackIncrement = 1.0f / (_sampleRate * _attackTime);
+  _decayIncrement = 1.0f / (_sampleRate * _decayTime);
+  _releaseIncrement = 1.0f / (_sampleRate * _releaseTime);
+  // エコーの時間が0なら次のサイクルで終わる
+  _echoIncrement = _echoTime > 0.0f ? 1.0f / (_sampleRate * _echoTime) : 1.0f;
 }
 
 // 各パラメータの値を定数で記述した最大値・最小値の範囲に収める。
@@ -120,13 +146,12 @@ bool AmpEnvelope::isEchoEnded() {
 }
 
 // エンベロープの計算処理を1サンプル分進める。この計算処理を実行することで変数の値が更新される。
-void AmpEnvelope::cycle(float sampleRate) {
-  _sampleRate = sampleRate;
+void AmpEnvelope::cycle() {
   switch (_ampState) {
     // Attack状態時の更新処理
     case AMPENV_STATE::ATTACK:
       _value = _timer * (2.0f - _timer);
-      _timer += 1.0f / (_sampleRate * _attackTime);
+      _timer += _attackIncrement;
       if (_timer >= 1.0f) {
         _value = AMP_MAX;
         _timer = 0.0f;
@@ -137,7 +162,7 @@ void AmpEnvelope::cycle(float sampleRate) {
     case AMPENV_STATE::DECAY:
       _value = (1.0f - _sustainValue) * (_timer - 1.0f) * (_timer - 1.0f) +
                _sustainValue;
-      _timer += 1.0f / (_sampleRate * _decayTime);
+      _timer += _decayIncrement;
       if (_timer >= 1.0f) {
         _value = _sustainValue;
         _timer = 0.0f;
@@ -152,7 +177,7 @@ void AmpEnvelope::cycle(float sampleRate) {
     // Release状態時の更新処理
     case AMPENV_STATE::RELEASE:
       _value = (_valueOnReleaseStart) * (_timer - 1.0f) * (_timer - 1.0f);
-      _timer += 1.0f / (_sampleRate * (_releaseTime));
+      _timer += _releaseIncrement;
       if (_timer >= 1.0f) {
         _value = AMP_MIN;
         _timer = 0.0f;
@@ -162,10 +187,111 @@ void AmpEnvelope::cycle(float sampleRate) {
     // Wait状態時の更新処理
     case AMPENV_STATE::WAIT:
       _value = AMP_MIN;
-      _timer += 1.0f / (_sampleRate * _echoTime);
+      _timer += _echoIncrement;
       if (_timer >= 1.0f) {
         _ampState = AMPENV_STATE::ECHO;
       }
       break;
+    default:
+      break;
+  }
+}
+
+std::int32_t AmpEnvelope::renderBlock(float* dest, std::int32_t numSamples) {
+  auto activeSamples = numSamples;
+  auto position = 0;
+  while (position < numSamples) {
+    // 状態は区間の境目でしか変わらないため, 区間の先頭だけを調べればよい
+    if (activeSamples == numSamples && (isReleaseEnded() || isEchoEnded())) {
+      activeSamples = position;
+    }
+
+    auto* segment = dest + position;
+    const auto remaining = numSamples - position;
+    switch (_ampState) {
+      // t * (2 - t)
+      case AMPENV_STATE::ATTACK:
+        position += renderCurve(segment, remaining, _attackIncrement, -1.0f, 2.0f, 0.0f, AMP_MAX,
+                                AMPENV_STATE::DECAY);
+        break;
+      // (1 - s) * (t - 1)^2 + s
+      case AMPENV_STATE::DECAY: {
+        const auto range = 1.0f - _sustainValue;
+        position += renderCurve(segment, remaining, _decayIncrement, range, -2.0f * range, 1.0f, _sustainValue,
+                                AMPENV_STATE::SUSTAIN);
+        break;
+      }
+      // v0 * (t - 1)^2
+      case AMPENV_STATE::RELEASE:
+        position += renderCurve(segment, remaining, _releaseIncrement, _valueOnReleaseStart,
+                                -2.0f * _valueOnReleaseStart, _valueOnReleaseStart, AMP_MIN,
+                                AMPENV_STATE::WAIT);
+        break;
+      case AMPENV_STATE::WAIT:
+        position += renderWait(segment, remaining);
+        break;
+      // SUSTAINとECHOは値が変わらない
+      case AMPENV_STATE::SUSTAIN:
+        segment[0] = _value;
+        std::fill(segment + 1, segment + remaining, _sustainValue);
+        _value = _sustainValue;
+        _timer = 0.0f;
+        position = numSamples;
+        break;
+      default:
+        std::fill(segment, segment + remaining, _value);
+        position = numSamples;
+        break;
+    }
+  }
+  return activeSamples;
+}
+
+std::int32_t AmpEnvelope::renderCurve(float* dest, std::int32_t numSamples, float increment, float a, float b,
+                                      float c, float endValue, AMPENV_STATE nextState) {
+  // cycleはタイマーの値から求めた値を次のgetValue()で返すため, 書き込みは1サンプル遅れる
+  const auto cyclesBeforeEnd = getCyclesBeforeEnd(increment);
+  const auto count = std::min(numSamples, cyclesBeforeEnd + 1);
+  const auto start = _timer;
+
+  dest[0] = _value;
+  for (auto i = 1; i < count; ++i) {
+    const auto t = start + (float)(i - 1) * increment;
+    dest[i] = (a * t + b) * t + c;
+  }
+
+  if (count > cyclesBeforeEnd) {
+    _value = endValue;
+    _timer = 0.0f;
+    _ampState = nextState;
+  } else {
+    const auto t = start + (float)(count - 1) * increment;
+    _value = (a * t + b) * t + c;
+    _timer = start + (float)count * increment;
+  }
+  return count;
+}
+
+std::int32_t AmpEnvelope::renderWait(float* dest, std::int32_t numSamples) {
+  const auto cyclesBeforeEnd = getCyclesBeforeEnd(_echoIncrement);
+  const auto count = std::min(numSamples, cyclesBeforeEnd + 1);
+
+  dest[0] = _value;
+  std::fill(dest + 1, dest + count, AMP_MIN);
+
+  _value = AMP_MIN;
+  _timer += (float)count * _echoIncrement;
+  if (count > cyclesBeforeEnd) {
+    _ampState = AMPENV_STATE::ECHO;
   }
-}
\ No newline at end of file
+  return count;
+}
+
+std::int32_t AmpEnvelope::getCyclesBeforeEnd(float increment) const {
+  if (increment <= 0.0f) {
+    return std::numeric_limits<std::int32_t>::max() - 1;
+  }
+  // timer + (n + 1) * increment >= 1 となる最小のnまではcycleしても区間が終わらない
+  const auto cycles = std::ceil((1.0f - _timer) / increment) - 1.0f;
+  return (std::int32_t)std::min(std::max(cycles, 0.0f), (float)(std::numeric_limits<std::int32_t>::max() - 1));
+}
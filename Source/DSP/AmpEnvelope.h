@@ -11,6 +11,15 @@
 
 #pragma once
 
+#include <cstdint>
+
+/*
+--------------------------------------------------------------------------------
+AmpEnvelope
+ADSRの各区間の1サンプルあたりの増分は, パラメータかサンプルレートが変わったときにだけ計算する.
+renderBlockは区間の終わりまでを閉じた式でまとめて書き込み, 状態の切り替わりへ直接進む.
+--------------------------------------------------------------------------------
+*/
 class AmpEnvelope {
  public:
   enum class AMPENV_STATE {
@@ -30,6 +39,8 @@ class AmpEnvelope {
   float getValue();
   void setParameters(float attackTime, float decayTime, float sustain,
                      float releaseTime, float echoTime);
+  // cycleを呼ぶ頻度(Hz). サンプルレート以外にフレームレートなども指定できる
+  void setSampleRate(float sampleRate);
   void checkVarRange();
   void attackStart();
   void releaseStart();
@@ -38,13 +49,28 @@ class AmpEnvelope {
   bool isReleasing();
   bool isReleaseEnded();
   bool isEchoEnded();
-  void cycle(float sampleRate);
+  void cycle();
+  // getValue()とcycle()をnumSamples回繰り返したときのgetValue()の値をdestへ書き込む.
+  // 戻り値はisReleaseEnded()かisEchoEnded()になるまでのサンプル数
+  std::int32_t renderBlock(float* dest, std::int32_t numSamples);
 
  private:
   AmpEnvelope();
 
+  void updateIncrements();
+  // 2次式 (a * t + b) * t + c の区間を, 区間の終わりかnumSamplesまで書き込む
+  std::int32_t renderCurve(float* dest, std::int32_t numSamples, float increment, float a, float b, float c,
+                           float endValue, AMPENV_STATE nextState);
+  std::int32_t renderWait(float* dest, std::int32_t numSamples);
+  // 現在のタイマーから, 区間の終わりに達しないcycleの回数
+  std::int32_t getCyclesBeforeEnd(float increment) const;
+
   AMPENV_STATE _ampState;
   float _attackTime, _decayTime, _sustainValue, _releaseTime, _echoTime;
   float _value, _valueOnReleaseStart, _timer;
   float _sampleRate;
+  float _attackIncrement = 0.0f;
+  float _decayIncrement = 0.0f;
+  float _releaseIncrement = 0.0f;
+  float _echoIncrement = 0.0f;
 };
\ No newline at end of file
@@ -0,0 +1,216 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "MonoNoteStack.h"
+#include "SynthParameters.h"
+
+/*
+--------------------------------------------------------------------------------
+ChipSynthesiser
+MONO / PORTAMENTOではボイスの検索やスチールを使わず, MonoNoteStackで選んだノートを先頭のボイスで鳴らす.
+押したままの別のノートへ移るとき(レガート, トリル, 離したときの前のノートへの復帰)もボイスは同じものを使い続け,
+ボイス側は押鍵中のボイススチールとして受け取ってポルタメントやレガートを行う.
+サステインペダルを踏んでいる間に離したノートはPOLYと同じく押されたままとして扱い, ペダルを離したときにまとめて離す.
+POLYではjuce::Synthesiserの処理を使うが, 空きボイスの検索とスチールは先頭から有効なボイス数までに限る.
+ボイスは常に最大数だけ確保しておき, ボイシングの切り替えでは有効なボイス数を変えるだけにする.
+renderBlockはMIDIイベントの位置でボイスのレンダリングを区切り, イベントはその場で処理する.
+パラメータはプロセッサがサブブロックごとにVoiceParameterSnapshotへ読み込むため, 区切りごとには読まない.
+--------------------------------------------------------------------------------
+*/
+class ChipSynthesiser : public Synthesiser {
+ public:
+  explicit ChipSynthesiser(VoicingParameters* voicingParams) : _voicingParamsPtr(voicingParams) {}
+
+  void noteOn(int midiChannel, int midiNoteNumber, float velocity) override {
+    if (!isMonoMode()) {
+      clearMonoNotes();
+      Synthesiser::noteOn(midiChannel, midiNoteNumber, velocity);
+      return;
+    }
+
+    const ScopedLock sl(lock);
+    setSustained(midiNoteNumber, 0);
+    _noteStack.noteOn(midiNoteNumber, velocity);
+    playMonoNote(midiChannel);
+  }
+
+  void noteOff(int midiChannel, int midiNoteNumber, float velocity, bool allowTailOff) override {
+    if (!isMonoMode()) {
+      clearMonoNotes();
+      Synthesiser::noteOff(midiChannel, midiNoteNumber, velocity, allowTailOff);
+      return;
+    }
+
+    const ScopedLock sl(lock);
+    // ペダルを離すまでノートを押したままにしておく
+    if (isSustainPedalDown(midiChannel) && _noteStack.isHeld(midiNoteNumber)) {
+      setSustained(midiNoteNumber, midiChannel);
+      return;
+    }
+    _noteStack.noteOff(midiNoteNumber);
+    // POLYから切り替える前に他のボイスで鳴らし始めたノートはそのボイスで離す
+    if (midiNoteNumber != _monoNote) {
+      Synthesiser::noteOff(midiChannel, midiNoteNumber, velocity, allowTailOff);
+      return;
+    }
+    // まだ押されているノートがあれば, 同じボイスのままそのノートへ戻る
+    if (!_noteStack.isEmpty()) {
+      playMonoNote(midiChannel);
+      return;
+    }
+    _monoNote = -1;
+    Synthesiser::noteOff(midiChannel, midiNoteNumber, velocity, allowTailOff);
+  }
+
+  void allNotesOff(int midiChannel, bool allowTailOff) override {
+    clearMonoNotes();
+    // Synthesiser::allNotesOffと同じくペダルの状態も消す
+    _sustainPedalBits = 0;
+    Synthesiser::allNotesOff(midiChannel, allowTailOff);
+  }
+
+  void handleSustainPedal(int midiChannel, bool isDown) override {
+    const ScopedLock sl(lock);
+    if (midiChannel >= 1 && midiChannel <= 16) {
+      if (isDown) {
+        _sustainPedalBits |= 1u << midiChannel;
+      } else {
+        _sustainPedalBits &= ~(1u << midiChannel);
+        releaseSustainedNotes(midiChannel);
+      }
+    }
+    Synthesiser::handleSustainPedal(midiChannel, isDown);
+  }
+
+  // 新しいノートに割り当ててよいボイスの数. 範囲外のボイスは鳴っている音を最後まで鳴らす
+  void setNumActiveVoices(std::int32_t numActiveVoices) { _numActiveVoices = numActiveVoices; }
+
+  // イベントでレンダリングを区切る最小のサンプル数. これより近いイベントは区切りの先頭でまとめて処理する
+  void setMinimumSubBlockSize(std::int32_t numSamples) { _minimumSubBlockSize = jmax(1, numSamples); }
+
+  // bufferのstartSampleからnumSamplesをレンダリングする. midiDataの時刻はstartSampleを0とする
+  void renderBlock(AudioBuffer<float>& buffer, const MidiBuffer& midiData, std::int32_t startSample,
+                   std::int32_t numSamples) {
+    const ScopedLock sl(lock);
+    if (getSampleRate() == 0.0) {
+      return;
+    }
+
+    auto position = 0;
+    for (const auto metadata : midiData) {
+      // 範囲外のイベントは最後のサンプルで処理する
+      const auto eventPosition = jlimit(0, numSamples, metadata.samplePosition);
+      const auto gap = eventPosition - position;
+      // 最小の長さに満たない区間は区切らず, イベントを区間の先頭で処理する
+      if (gap >= _minimumSubBlockSize) {
+        renderVoices(buffer, startSample + position, gap);
+        position = eventPosition;
+      }
+      handleMidiEvent(metadata.getMessage());
+    }
+    if (position < numSamples) {
+      renderVoices(buffer, startSample + position, numSamples - position);
+    }
+  }
+
+ protected:
+  SynthesiserVoice* findFreeVoice(SynthesiserSound* soundToPlay, int midiChannel, int midiNoteNumber,
+                                  bool stealIfNoneAvailable) const override {
+    const ScopedLock sl(lock);
+    const auto numActiveVoices = jmin(_numActiveVoices, voices.size());
+    for (auto i = 0; i < numActiveVoices; ++i) {
+      auto* voice = voices.getUnchecked(i);
+      if (!voice->isVoiceActive() && voice->canPlaySound(soundToPlay)) {
+        return voice;
+      }
+    }
+    if (!stealIfNoneAvailable) {
+      return nullptr;
+    }
+    if (numActiveVoices == voices.size()) {
+      return findVoiceToSteal(soundToPlay, midiChannel, midiNoteNumber);
+    }
+
+    // 有効なボイスの中で最も古く発音したものを使う
+    SynthesiserVoice* oldest = nullptr;
+    for (auto i = 0; i < numActiveVoices; ++i) {
+      auto* voice = voices.getUnchecked(i);
+      if (voice->canPlaySound(soundToPlay) && (oldest == nullptr || voice->wasStartedBefore(*oldest))) {
+        oldest = voice;
+      }
+    }
+    return oldest;
+  }
+
+ private:
+  bool isMonoMode() const {
+    return toChipType<VOICING_TYPE>(_voicingParamsPtr->VoicingSwitch) != VOICING_TYPE::POLY;
+  }
+
+  void clearMonoNotes() {
+    if (_monoNote >= 0 || !_noteStack.isEmpty()) {
+      _noteStack.clear();
+      _monoNote = -1;
+      std::fill(std::begin(_sustainedChannels), std::end(_sustainedChannels), (std::int8_t)0);
+    }
+  }
+
+  bool isSustainPedalDown(int midiChannel) const {
+    return midiChannel >= 1 && midiChannel <= 16 && ((_sustainPedalBits >> midiChannel) & 1u);
+  }
+
+  void setSustained(int midiNoteNumber, int midiChannel) {
+    if (midiNoteNumber >= 0 && midiNoteNumber < MonoNoteStack::NUM_OF_NOTES) {
+      _sustainedChannels[midiNoteNumber] = (std::int8_t)midiChannel;
+    }
+  }
+
+  // ペダルを踏んでいる間に離したノートをまとめて離す. 鳴っているノートが離されたときだけ,
+  // 残っているノートへ移るか音を止める. 先に全て離すため, 途中のノートへ移り直すことはない
+  void releaseSustainedNotes(int midiChannel) {
+    auto isMonoNoteReleased = false;
+    for (auto note = 0; note < MonoNoteStack::NUM_OF_NOTES; ++note) {
+      if (_sustainedChannels[note] == midiChannel) {
+        _sustainedChannels[note] = 0;
+        _noteStack.noteOff(note);
+        isMonoNoteReleased = isMonoNoteReleased || (note == _monoNote);
+      }
+    }
+    if (!isMonoNoteReleased) {
+      return;
+    }
+    if (!_noteStack.isEmpty()) {
+      playMonoNote(midiChannel);
+      return;
+    }
+    const auto note = _monoNote;
+    _monoNote = -1;
+    // ボイスはまだペダルを踏んだ状態なので, 続くSynthesiser::handleSustainPedalでリリースする
+    Synthesiser::noteOff(midiChannel, note, 0.0f, true);
+  }
+
+  // 優先するノートが鳴っているノートと違えば, 先頭のボイスで鳴らし直す
+  void playMonoNote(int midiChannel) {
+    const auto note = _noteStack.getNote(toChipType<NOTE_PRIORITY_TYPE>(_voicingParamsPtr->NotePriority));
+    if (note < 0 || note == _monoNote || voices.isEmpty() || sounds.isEmpty()) {
+      return;
+    }
+    auto* sound = sounds.getUnchecked(0).get();
+    if (!sound->appliesToNote(note) || !sound->appliesToChannel(midiChannel)) {
+      return;
+    }
+    _monoNote = note;
+    startVoice(voices.getUnchecked(0), sound, midiChannel, note, _noteStack.getVelocity(note));
+  }
+
+  VoicingParameters* _voicingParamsPtr;
+  MonoNoteStack _noteStack;
+  // 先頭のボイスで鳴らしているノート. 押されていなければ-1
+  std::int32_t _monoNote = -1;
+  // サステインペダルを踏んでいるチャンネル(ビット1から16)
+  uint32 _sustainPedalBits = 0;
+  // ペダルを踏んでいる間に離したノートのチャンネル. 離していなければ0
+  std::int8_t _sustainedChannels[MonoNoteStack::NUM_OF_NOTES] = {};
+  std::int32_t _numActiveVoices = VOICE_MAX;
+  std::int32_t _minimumSubBlockSize = 1;
+};
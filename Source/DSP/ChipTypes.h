@@ -0,0 +1,293 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+class Waveforms;
+class WaveformMemoryParameters;
+
+/*
+--------------------------------------------------------------------------------
+ChipTypes
+波形 / 音色エンベロープ / ボイシング / スイープ / マクロのクロック / グライド / ノートの優先度 / ボイスフィルタの種類を列挙型と定数テーブルで定義する.
+パラメータの選択肢(GUIのコンボボックスもここから作られる)と音声処理の分岐の両方を
+このテーブルから引くため, オーディオスレッドでは文字列を扱わずインデックスだけで処理できる.
+テーブルの並びは保存済みのステートと互換を保つため, 以前の選択肢の並びと同じにしている.
+--------------------------------------------------------------------------------
+*/
+enum class WAVE_TYPE {
+  NES_SQUARE50 = 0,
+  NES_SQUARE25,
+  NES_SQUARE125,
+  NES_TRIANGLE,
+  NES_LONG_NOISE,
+  NES_SHORT_NOISE,
+  PURE_SQUARE50,
+  PURE_SQUARE25,
+  PURE_SQUARE125,
+  PURE_TRIANGLE,
+  PURE_SINE,
+  PURE_SAW,
+  PURE_NOISE,
+  ROUGH_SINE,
+  ROUGH_SAW,
+  ROUGH_NOISE,
+  WAVEFORM_MEMORY,
+};
+
+enum class COLOR_TYPE {
+  NONE = 0,
+  ARP_OCTAVE,
+  ARP_4TH,
+  ARP_5TH,
+  ARP_MAJOR,
+  ARP_MAJOR7TH,
+  ORC_HIT,
+  ORC_HIT2,
+  ORC_HIT3,
+  USER,
+};
+
+enum class VOICING_TYPE {
+  POLY = 0,
+  MONO,
+  PORTAMENTO,
+};
+
+enum class SWEEP_TYPE {
+  OFF = 0,
+  POSITIVE,
+  NEGATIVE,
+};
+
+enum class MACRO_CLOCK_TYPE {
+  NTSC = 0,
+  PAL,
+  TEMPO,
+  // フレームに分けずサンプルごとにマクロを進める. MACRO_CLOCKを追加する前の音と同じになる
+  SAMPLE,
+};
+
+enum class GLIDE_MODE_TYPE {
+  CONSTANT_TIME = 0,
+  CONSTANT_RATE,
+};
+
+enum class NOTE_PRIORITY_TYPE {
+  LAST = 0,
+  LOW,
+  HIGH,
+};
+
+enum class VOICE_FILTER_TYPE {
+  LOWPASS = 0,
+  HIGHPASS,
+  BANDPASS,
+};
+
+// 1サンプル分の波形を生成する関数. 定義はWaveforms.cpp
+using WaveKernel = float (*)(Waveforms& waveforms, float angle, float angleDelta,
+                             WaveformMemoryParameters* waveformMemoryParams);
+
+namespace WaveKernels {
+float nesSquare50(Waveforms& w, float angle, float angleDelta, WaveformMemoryParameters* m);
+float nesSquare25(Waveforms& w, float angle, float angleDelta, WaveformMemoryParameters* m);
+float nesSquare125(Waveforms& w, float angle, float angleDelta, WaveformMemoryParameters* m);
+float nesTriangle(Waveforms& w, float angle, float angleDelta, WaveformMemoryParameters* m);
+float nesLongNoise(Waveforms& w, float angle, float angleDelta, WaveformMemoryParameters* m);
+float nesShortNoise(Waveforms& w, float angle, float angleDelta, WaveformMemoryParameters* m);
+float pureSquare50(Waveforms& w, float angle, float angleDelta, WaveformMemoryParameters* m);
+float pureSquare25(Waveforms& w, float angle, float angleDelta, WaveformMemoryParameters* m);
+float pureSquare125(Waveforms& w, float angle, float angleDelta, WaveformMemoryParameters* m);
+float pureTriangle(Waveforms& w, float angle, float angleDelta, WaveformMemoryParameters* m);
+float pureSine(Waveforms& w, float angle, float angleDelta, WaveformMemoryParameters* m);
+float pureSaw(Waveforms& w, float angle, float angleDelta, WaveformMemoryParameters* m);
+float pureNoise(Waveforms& w, float angle, float angleDelta, WaveformMemoryParameters* m);
+float roughSine(Waveforms& w, float angle, float angleDelta, WaveformMemoryParameters* m);
+float roughSaw(Waveforms& w, float angle, float angleDelta, WaveformMemoryParameters* m);
+float roughNoise(Waveforms& w, float angle, float angleDelta, WaveformMemoryParameters* m);
+float waveformMemory(Waveforms& w, float angle, float angleDelta, WaveformMemoryParameters* m);
+}  // namespace WaveKernels
+
+struct WaveTypeInfo {
+  WAVE_TYPE type;
+  const char* name;
+  WaveKernel kernel;
+};
+
+// 音色エンベロープのステップごとの音程(半音). 最後まで進むとloopStartへ戻り,
+// loopStartが負なら最後のステップを保持する. USERはlengthが0で, ステップはパラメータから作る
+struct ColorTypeInfo {
+  COLOR_TYPE type;
+  const char* name;
+  std::int32_t length;
+  std::int32_t loopStart;
+  std::int32_t steps[4];
+};
+
+struct VoicingTypeInfo {
+  VOICING_TYPE type;
+  const char* name;
+};
+
+struct SweepTypeInfo {
+  SWEEP_TYPE type;
+  const char* name;
+};
+
+// TEMPOのframeRateは4分音符あたりのフレーム数. SAMPLEは使わない(サンプルレートと同じ). それ以外はHz
+struct MacroClockTypeInfo {
+  MACRO_CLOCK_TYPE type;
+  const char* name;
+  float frameRate;
+};
+
+struct GlideModeTypeInfo {
+  GLIDE_MODE_TYPE type;
+  const char* name;
+};
+
+struct NotePriorityTypeInfo {
+  NOTE_PRIORITY_TYPE type;
+  const char* name;
+};
+
+// State Variable Filterの出力の混ぜ方. 出力 = inputMix * 入力 + bandMix * k * バンドパス + lowMix * ローパス
+// (kは1 / レゾナンス)
+struct VoiceFilterTypeInfo {
+  VOICE_FILTER_TYPE type;
+  const char* name;
+  float inputMix;
+  float bandMix;
+  float lowMix;
+};
+
+constexpr WaveTypeInfo WAVE_TYPE_INFOS[] = {
+  {WAVE_TYPE::NES_SQUARE50, "NES_Square50%", WaveKernels::nesSquare50},
+  {WAVE_TYPE::NES_SQUARE25, "NES_Square25%", WaveKernels::nesSquare25},
+  {WAVE_TYPE::NES_SQUARE125, "NES_Square12.5%", WaveKernels::nesSquare125},
+  {WAVE_TYPE::NES_TRIANGLE, "NES_Triangle", WaveKernels::nesTriangle},
+  {WAVE_TYPE::NES_LONG_NOISE, "NES_LongNoise", WaveKernels::nesLongNoise},
+  {WAVE_TYPE::NES_SHORT_NOISE, "NES_ShortNoise", WaveKernels::nesShortNoise},
+  {WAVE_TYPE::PURE_SQUARE50, "Pure_Square50%", WaveKernels::pureSquare50},
+  {WAVE_TYPE::PURE_SQUARE25, "Pure_Square25%", WaveKernels::pureSquare25},
+  {WAVE_TYPE::PURE_SQUARE125, "Pure_Square12.5%", WaveKernels::pureSquare125},
+  {WAVE_TYPE::PURE_TRIANGLE, "Pure_Triangle", WaveKernels::pureTriangle},
+  {WAVE_TYPE::PURE_SINE, "Pure_Sine", WaveKernels::pureSine},
+  {WAVE_TYPE::PURE_SAW, "Pure_Saw", WaveKernels::pureSaw},
+  {WAVE_TYPE::PURE_NOISE, "Pure_Noise", WaveKernels::pureNoise},
+  {WAVE_TYPE::ROUGH_SINE, "Rough_Sine", WaveKernels::roughSine},
+  {WAVE_TYPE::ROUGH_SAW, "Rough_Saw", WaveKernels::roughSaw},
+  {WAVE_TYPE::ROUGH_NOISE, "Rough_Noise", WaveKernels::roughNoise},
+  {WAVE_TYPE::WAVEFORM_MEMORY, "Waveform Memory", WaveKernels::waveformMemory},
+};
+
+constexpr ColorTypeInfo COLOR_TYPE_INFOS[] = {
+  {COLOR_TYPE::NONE, "NONE", 1, 0, {0, 0, 0, 0}},
+  {COLOR_TYPE::ARP_OCTAVE, "ARP_Octave", 2, 0, {12, 0, 0, 0}},
+  {COLOR_TYPE::ARP_4TH, "ARP_4th", 2, 0, {5, 0, 0, 0}},
+  {COLOR_TYPE::ARP_5TH, "ARP_5th", 2, 0, {7, 0, 0, 0}},
+  {COLOR_TYPE::ARP_MAJOR, "ARP_Major", 3, 0, {4, 7, 0, 0}},
+  {COLOR_TYPE::ARP_MAJOR7TH, "ARP_Major7th", 4, 0, {4, 7, 11, 0}},
+  {COLOR_TYPE::ORC_HIT, "ORC_HIT", 2, -1, {12, 0, 0, 0}},
+  {COLOR_TYPE::ORC_HIT2, "ORC_HIT2", 3, -1, {24, 12, 0, 0}},
+  {COLOR_TYPE::ORC_HIT3, "ORC_HIT3", 3, -1, {-2, -1, 0, 0}},
+  {COLOR_TYPE::USER, "USER", 0, 0, {0, 0, 0, 0}},
+};
+
+constexpr VoicingTypeInfo VOICING_TYPE_INFOS[] = {
+  {VOICING_TYPE::POLY, "POLY"},
+  {VOICING_TYPE::MONO, "MONO"},
+  {VOICING_TYPE::PORTAMENTO, "PORTAMENTO"},
+};
+
+constexpr SweepTypeInfo SWEEP_TYPE_INFOS[] = {
+  {SWEEP_TYPE::OFF, "OFF"},
+  {SWEEP_TYPE::POSITIVE, "Positive"},
+  {SWEEP_TYPE::NEGATIVE, "Negative"},
+};
+
+constexpr MacroClockTypeInfo MACRO_CLOCK_TYPE_INFOS[] = {
+  {MACRO_CLOCK_TYPE::NTSC, "NTSC_60Hz", 60.0f},
+  {MACRO_CLOCK_TYPE::PAL, "PAL_50Hz", 50.0f},
+  {MACRO_CLOCK_TYPE::TEMPO, "Tempo_24PPQ", 24.0f},
+  {MACRO_CLOCK_TYPE::SAMPLE, "Per_Sample", 0.0f},
+};
+
+constexpr GlideModeTypeInfo GLIDE_MODE_TYPE_INFOS[] = {
+  {GLIDE_MODE_TYPE::CONSTANT_TIME, "Constant_Time"},
+  {GLIDE_MODE_TYPE::CONSTANT_RATE, "Constant_Rate"},
+};
+
+constexpr NotePriorityTypeInfo NOTE_PRIORITY_TYPE_INFOS[] = {
+  {NOTE_PRIORITY_TYPE::LAST, "Last"},
+  {NOTE_PRIORITY_TYPE::LOW, "Low"},
+  {NOTE_PRIORITY_TYPE::HIGH, "High"},
+};
+
+constexpr VoiceFilterTypeInfo VOICE_FILTER_TYPE_INFOS[] = {
+  {VOICE_FILTER_TYPE::LOWPASS, "LowPass", 0.0f, 0.0f, 1.0f},
+  {VOICE_FILTER_TYPE::HIGHPASS, "HighPass", 1.0f, -1.0f, -1.0f},
+  {VOICE_FILTER_TYPE::BANDPASS, "BandPass", 0.0f, 1.0f, 0.0f},
+};
+
+// テーブルがenumの値の順に並んでいるか
+template <typename Info, size_t N>
+constexpr bool isOrderedByType(const Info (&infos)[N]) {
+  for (size_t i = 0; i < N; ++i) {
+    if ((size_t)infos[i].type != i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static_assert(isOrderedByType(WAVE_TYPE_INFOS), "WAVE_TYPE_INFOS must be ordered by WAVE_TYPE");
+static_assert(isOrderedByType(COLOR_TYPE_INFOS), "COLOR_TYPE_INFOS must be ordered by COLOR_TYPE");
+static_assert(isOrderedByType(VOICING_TYPE_INFOS), "VOICING_TYPE_INFOS must be ordered by VOICING_TYPE");
+static_assert(isOrderedByType(SWEEP_TYPE_INFOS), "SWEEP_TYPE_INFOS must be ordered by SWEEP_TYPE");
+static_assert(isOrderedByType(MACRO_CLOCK_TYPE_INFOS), "MACRO_CLOCK_TYPE_INFOS must be ordered by MACRO_CLOCK_TYPE");
+static_assert(isOrderedByType(GLIDE_MODE_TYPE_INFOS), "GLIDE_MODE_TYPE_INFOS must be ordered by GLIDE_MODE_TYPE");
+static_assert(isOrderedByType(NOTE_PRIORITY_TYPE_INFOS), "NOTE_PRIORITY_TYPE_INFOS must be ordered by NOTE_PRIORITY_TYPE");
+static_assert(isOrderedByType(VOICE_FILTER_TYPE_INFOS), "VOICE_FILTER_TYPE_INFOS must be ordered by VOICE_FILTER_TYPE");
+
+constexpr std::int32_t NUM_OF_WAVE_TYPES = (std::int32_t)(sizeof(WAVE_TYPE_INFOS) / sizeof(WAVE_TYPE_INFOS[0]));
+constexpr std::int32_t NUM_OF_COLOR_TYPES = (std::int32_t)(sizeof(COLOR_TYPE_INFOS) / sizeof(COLOR_TYPE_INFOS[0]));
+constexpr std::int32_t NUM_OF_VOICING_TYPES =
+    (std::int32_t)(sizeof(VOICING_TYPE_INFOS) / sizeof(VOICING_TYPE_INFOS[0]));
+constexpr std::int32_t NUM_OF_SWEEP_TYPES = (std::int32_t)(sizeof(SWEEP_TYPE_INFOS) / sizeof(SWEEP_TYPE_INFOS[0]));
+constexpr std::int32_t NUM_OF_MACRO_CLOCK_TYPES =
+    (std::int32_t)(sizeof(MACRO_CLOCK_TYPE_INFOS) / sizeof(MACRO_CLOCK_TYPE_INFOS[0]));
+constexpr std::int32_t NUM_OF_GLIDE_MODE_TYPES =
+    (std::int32_t)(sizeof(GLIDE_MODE_TYPE_INFOS) / sizeof(GLIDE_MODE_TYPE_INFOS[0]));
+constexpr std::int32_t NUM_OF_NOTE_PRIORITY_TYPES =
+    (std::int32_t)(sizeof(NOTE_PRIORITY_TYPE_INFOS) / sizeof(NOTE_PRIORITY_TYPE_INFOS[0]));
+constexpr std::int32_t NUM_OF_VOICE_FILTER_TYPES =
+    (std::int32_t)(sizeof(VOICE_FILTER_TYPE_INFOS) / sizeof(VOICE_FILTER_TYPE_INFOS[0]));
+
+// AudioParameterChoiceの選択肢を作る. パラメータの生成時にだけ使う
+template <typename Info, size_t N>
+StringArray getChoiceNames(const Info (&infos)[N]) {
+  StringArray names;
+  for (const auto& info : infos) {
+    names.add(info.name);
+  }
+  return names;
+}
+
+// AudioParameterChoiceの現在のインデックスをenumへ変換する
+template <typename Type>
+Type toChipType(const AudioParameterChoice* param) {
+  return (Type)param->getIndex();
+}
+
+inline const WaveTypeInfo& getWaveTypeInfo(WAVE_TYPE type) {
+  return WAVE_TYPE_INFOS[jlimit(0, NUM_OF_WAVE_TYPES - 1, (std::int32_t)type)];
+}
+
+inline const ColorTypeInfo& getColorTypeInfo(COLOR_TYPE type) {
+  return COLOR_TYPE_INFOS[jlimit(0, NUM_OF_COLOR_TYPES - 1, (std::int32_t)type)];
+}
+
+inline const VoiceFilterTypeInfo& getVoiceFilterTypeInfo(VOICE_FILTER_TYPE type) {
+  return VOICE_FILTER_TYPE_INFOS[jlimit(0, NUM_OF_VOICE_FILTER_TYPES - 1, (std::int32_t)type)];
+}
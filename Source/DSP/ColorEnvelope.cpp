@@ -1,99 +1,37 @@
 #include "ColorEnvelope.h"
 
-#include "SynthParameters.h"
-
-ColorEnvelope::ColorEnvelope(ChipOscillatorParameters* chipOscParam) {
-  _chipOscParam = chipOscParam;
+ColorEnvelope::ColorEnvelope(ChipOscillatorParameters* chipOscParam, const ColorTableBank* tableBank)
+    : _chipOscParam(chipOscParam), _tableBank(tableBank) {
+  _sequence = &_tableBank->getSequence(COLOR_TYPE::NONE);
 }
 
-float ColorEnvelope::getManipulateAngle() {
-  const auto name = _chipOscParam->ColorType->getCurrentChoiceName();
-  if (name == "ARP_Octave") {
-    if (_index % 2 == 0) {
-      return 1;
-    } else {
-      return 0;
-    } 
-  } else if (name ==  "ARP_4th") {
-    if (_index % 2 == 0) {
-      return degreeFactor(5);
-    } else {
-      return 0;
-    }
-  } else if (name ==  "ARP_5th") {
-    if (_index % 2 == 0) {
-      return degreeFactor(7);
-    } else {
-      return 0;
-    }
-  } else if (name ==  "ARP_Major") {
-    if (_index % 3 == 0) {
-      return degreeFactor(4);
-    } else if (_index % 3 == 1) {
-      return degreeFactor(7);
-    } else {
-      return 0;
-    }  
-  } else if (name == "ARP_Major7th") {
-    if (_index % 4 == 0) {
-      return degreeFactor(4);
-    } else if (_index % 4 == 1) {
-        return degreeFactor(7);
-    } else if (_index % 4 == 2) {
-        return degreeFactor(11);
-    } else {
-      return 0;
-    }
-  } else if (name == "ORC_HIT") {
-    _isLoop = false;
-    if (_index == 0) {
-      return degreeFactor(12);
-    } else {
-      return 0;
-    }
-  } else if (name == "ORC_HIT2") {
-    _isLoop = false;
-    if (_index == 0) {
-      return degreeFactor(24);
-    } else if (_index == 1) {
-      return degreeFactor(12);
-    } else {
-      return 0;
-    }
-  } else if (name == "ORC_HIT3") {
-    _isLoop = false;
-    if (_index == 0) {
-      return degreeFactor(-2);
-    } else if (_index == 1) {
-      return degreeFactor(-1);
-    } else {
-      return 0;
-    }
-  }
+void ColorEnvelope::beginBlock(float frameRate) {
+  _sequence = &_tableBank->getSequence(toChipType<COLOR_TYPE>(_chipOscParam->ColorType));
+  _stepFrames = jmax(1, roundToInt(_chipOscParam->ColorDuration->get() * frameRate));
+  // 種類やUSERの長さが変わって範囲外になった場合
+  clampIndex();
 }
 
 void ColorEnvelope::clear() {
-  _timer = 0;
+  _counter = 0;
   _index = 0;
-  _isLoop = true;
 }
 
-void ColorEnvelope::cycle(float sampleRate) {
-  _envDuration = _chipOscParam->ColorDuration->get();
-  _timer += 1 / sampleRate;
-  if (_timer >= _envDuration) {
-    _index = (_index + 1);
-    _timer = 0.0f;
+void ColorEnvelope::cycle() {
+  if (++_counter < _stepFrames) {
+    return;
+  }
+  _counter = 0;
 
-    // index‚ðƒ‹[ƒv‚³‚¹‚é‚©‚Ç‚¤‚©
-    if (_isLoop) {
-      _index = _index  % 12;
-    } else {
-      _index = std::min(_index, 12);
-    }
+  if (++_index >= _sequence->length) {
+    clampIndex();
   }
 }
 
-float ColorEnvelope::degreeFactor(int degree) {
-  return  (pow(2.0f, (float)degree / 12.f) - 1.0f);
-}
\ No newline at end of file
+void ColorEnvelope::clampIndex() {
+  if (_index < _sequence->length) {
+    return;
+  }
+  // ループしない場合は最後のステップで止める
+  _index = _sequence->loopStart >= 0 ? _sequence->loopStart : _sequence->length - 1;
+}
@@ -1,18 +1,28 @@
 #pragma once
-class ChipOscillatorParameters;
+#include "ColorTable.h"
 
+/*
+--------------------------------------------------------------------------------
+ColorEnvelope
+ColorTableBankの周波数比をステップごとに読み進める. MacroClockのフレームごとにcycleを呼び,
+ステップの長さは整数のフレーム数で数えるため, 浮動小数点の時間を積算したときのような誤差の蓄積がない.
+種類とステップの長さはbeginBlockでブロックごとに1回だけ読み込む.
+--------------------------------------------------------------------------------
+*/
 class ColorEnvelope {
  public:
-  ColorEnvelope(ChipOscillatorParameters* chipOscParam);
-  float getManipulateAngle();
+  ColorEnvelope(ChipOscillatorParameters* chipOscParam, const ColorTableBank* tableBank);
+  void beginBlock(float frameRate);
+  float getRatio() const { return _sequence->ratios[_index]; }
   void clear();
-  void cycle(float sampleRate);
+  void cycle();
  private:
-  float degreeFactor(int degree);
+  void clampIndex();
 
   ChipOscillatorParameters* _chipOscParam = nullptr;
-  float _envDuration = 0.05f;
-  float _timer = 0.0f;
-  int _index = 0;
-  bool _isLoop = true;
-};
\ No newline at end of file
+  const ColorTableBank* _tableBank = nullptr;
+  const ColorSequence* _sequence = nullptr;
+  std::int32_t _stepFrames = 1;
+  std::int32_t _counter = 0;
+  std::int32_t _index = 0;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "SynthParameters.h"
+
+/*
+--------------------------------------------------------------------------------
+ColorTableBank
+音色エンベロープ(アルペジオ / オーケストラヒット)の各ステップの周波数比をまとめたテーブル.
+組み込みの種類はCOLOR_TYPE_INFOSの半音から生成時に1度だけ変換する.
+USERはColorSequenceParametersから作り, サブブロックごとにパラメータを比べて変更があったときだけ作り直す.
+オーディオスレッドでは周波数比の表を引くだけで, pow()を呼ばない.
+--------------------------------------------------------------------------------
+*/
+struct ColorSequence {
+  std::int32_t length = 1;
+  // 最後のステップの次に戻るステップ. 負なら最後のステップを保持する
+  std::int32_t loopStart = 0;
+  float ratios[COLOR_SEQUENCE_LENGTH];
+};
+
+class ColorTableBank {
+ public:
+  ColorTableBank() {
+    for (auto i = 0; i < NUM_OF_COLOR_TYPES; ++i) {
+      const auto& info = COLOR_TYPE_INFOS[i];
+      auto& sequence = sequences[i];
+      std::fill(std::begin(sequence.ratios), std::end(sequence.ratios), 1.0f);
+      sequence.length = jmax(1, info.length);
+      sequence.loopStart = info.loopStart;
+      for (auto step = 0; step < info.length; ++step) {
+        sequence.ratios[step] = semitoneToRatio(info.steps[step]);
+      }
+    }
+    std::fill(std::begin(userSteps), std::end(userSteps), 0);
+  }
+
+  // USERのステップをパラメータと比べ, 変わっていれば周波数比を作り直す
+  void updateUserSequence(const ColorSequenceParameters& params) {
+    auto& sequence = sequences[(std::int32_t)COLOR_TYPE::USER];
+    const auto length = params.Length->get();
+    const auto loopStart = params.LoopEnabled->get() ? jmin(params.LoopStart->get(), length - 1) : -1;
+    sequence.length = length;
+    sequence.loopStart = loopStart;
+
+    for (auto i = 0; i < length; ++i) {
+      const auto semitone = params.Steps[i]->get();
+      if (semitone != userSteps[i]) {
+        userSteps[i] = semitone;
+        sequence.ratios[i] = semitoneToRatio(semitone);
+      }
+    }
+  }
+
+  const ColorSequence& getSequence(COLOR_TYPE type) const {
+    return sequences[jlimit(0, NUM_OF_COLOR_TYPES - 1, (std::int32_t)type)];
+  }
+
+ private:
+  static float semitoneToRatio(std::int32_t semitone) { return std::pow(2.0f, (float)semitone / 12.0f); }
+
+  ColorSequence sequences[NUM_OF_COLOR_TYPES];
+  // 周波数比を作ったときのUSERの音程
+  std::int32_t userSteps[COLOR_SEQUENCE_LENGTH];
+};
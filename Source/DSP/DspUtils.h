@@ -183,29 +183,30 @@ class antiAliasFilter {
     simpleFilter.LowPass(20000.0f, 1 / 4.0f, float(sampleRate * upSamplingFactor));
   };
 
-  void process(AudioBuffer<float> &buffer, AudioBuffer<float> &upSampleBuffer,
+  // upSampleBufferの先頭numSamples * upSamplingFactorサンプルにLPFをかけて間引き,
+  // bufferのstartSampleから書き込む. 作業用の領域は確保せずその場で処理する
+  void process(AudioBuffer<float> &buffer, std::int32_t startSample, std::int32_t numSamples,
+               AudioBuffer<float> &upSampleBuffer,
                std::int32_t totalNumInputChannels,
                std::int32_t totalNumOutputChannels) {
-    auto size = buffer.getNumSamples();
-    auto upSize = buffer.getNumSamples() * upSamplingFactor;
-    std::vector<float> input(upSize);
-    std::vector<float> output(upSize);
-
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i) {
-      for (auto j = 0; j < upSize; ++j) {
-        input[j] = upSampleBuffer.getSample(i, j);
-      }
+    if (totalNumInputChannels >= totalNumOutputChannels) {
+      return;
     }
 
+    // ボイスは全チャンネルに同じ値を書き込むので, 最初の出力チャンネルだけにフィルタをかける
+    auto *upSampled = upSampleBuffer.getWritePointer(totalNumInputChannels);
+    const auto upSize = numSamples * upSamplingFactor;
+
     // apply LPF for anti aliasing
     for (auto i = 0; i < upSize; ++i) {
-      output[i] = simpleFilter.Process(input[i]);
+      upSampled[i] = simpleFilter.Process(upSampled[i]);
     }
 
     // DownSampling
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i) {
-      for (auto j = 0; j < size; ++j) {
-        buffer.setSample(i, j, output[upSamplingFactor * j]);
+      auto *output = buffer.getWritePointer(i, startSample);
+      for (auto j = 0; j < numSamples; ++j) {
+        output[j] = upSampled[upSamplingFactor * j];
       }
     }
   }
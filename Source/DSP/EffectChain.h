@@ -0,0 +1,227 @@
+#pragma once
+
+#include <vector>
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "SoftClipper.h"
+#include "SynthParameters.h"
+
+/*
+--------------------------------------------------------------------------------
+PostEffectChain
+ボイス合成後のエフェクト(ドライブ → ハイカット → ローカット → クリッパー → スコープ)を
+小さなサブブロック単位で1回の走査にまとめて処理するクラス.
+サブブロックがキャッシュに載ったまま全段を通すため, ホストのブロックサイズが大きくても
+バッファ全体を何度も読み書きしなくて済む.
+フィルタの有効/無効はブロックごとにテンプレート引数で切り替え, 無効な段はコードごと消える.
+ドライブのゲインとフィルタの周波数は, 値が変わったときだけPARAMETER_RAMP_SECONDSかけて移動する.
+ゲインはサンプルごと, フィルタの係数はサブブロックごとに更新する.
+--------------------------------------------------------------------------------
+*/
+class PostEffectChain {
+ public:
+  static constexpr std::int32_t SUB_BLOCK_SIZE = SoftClipper::CHUNK_SIZE;
+
+  PostEffectChain(){};
+
+  void prepare(double sampleRate, std::int32_t numChannels) {
+    _sampleRate = sampleRate;
+    _hicut.prepare(numChannels);
+    _lowcut.prepare(numChannels);
+    _clipper.prepare(numChannels);
+
+    _gain.reset(sampleRate, PARAMETER_RAMP_SECONDS);
+    _hicutFreq.reset(sampleRate, PARAMETER_RAMP_SECONDS);
+    _lowcutFreq.reset(sampleRate, PARAMETER_RAMP_SECONDS);
+    // 次のsetParametersでは移動せずに値を設定し, 係数を必ず計算し直させる
+    _hasParameters = false;
+    _isHicutEnabled = false;
+    _isLowcutEnabled = false;
+  }
+
+  void reset() {
+    _hicut.reset();
+    _lowcut.reset();
+    _clipper.reset();
+  }
+
+  void setParameters(float driveDecibels, bool isHicutEnabled, float hicutFreq, bool isLowcutEnabled, float lowcutFreq) {
+    const auto gain = Decibels::decibelsToGain(driveDecibels);
+    if (_hasParameters) {
+      _gain.setTargetValue(gain);
+    } else {
+      _gain.setCurrentAndTargetValue(gain);
+    }
+
+    // 有効にした直後は移動せずに係数を計算し, 無効にする前の状態が出力に混ざらないよう状態を消す.
+    // 有効な間は周波数が変わったときだけ移動を始める
+    if (isHicutEnabled) {
+      if (_isHicutEnabled) {
+        _hicutFreq.setTargetValue(hicutFreq);
+      } else {
+        _hicutFreq.setCurrentAndTargetValue(hicutFreq);
+        _hicut.setCoefficients(makeLowPass(_sampleRate, hicutFreq));
+        _hicut.reset();
+      }
+    }
+    if (isLowcutEnabled) {
+      if (_isLowcutEnabled) {
+        _lowcutFreq.setTargetValue(lowcutFreq);
+      } else {
+        _lowcutFreq.setCurrentAndTargetValue(lowcutFreq);
+        _lowcut.setCoefficients(makeHighPass(_sampleRate, lowcutFreq));
+        _lowcut.reset();
+      }
+    }
+    _isHicutEnabled = isHicutEnabled;
+    _isLowcutEnabled = isLowcutEnabled;
+    _hasParameters = true;
+  }
+
+  // tapにはサブブロックごとに (先頭チャンネルのポインタ, サンプル数) が渡される
+  template <typename TapFunction>
+  void process(AudioBuffer<float>& buffer, std::int32_t startSample, std::int32_t numSamples, TapFunction&& tap) {
+    if (_isHicutEnabled) {
+      if (_isLowcutEnabled) {
+        processSubBlocks<true, true>(buffer, startSample, numSamples, tap);
+      } else {
+        processSubBlocks<true, false>(buffer, startSample, numSamples, tap);
+      }
+    } else {
+      if (_isLowcutEnabled) {
+        processSubBlocks<false, true>(buffer, startSample, numSamples, tap);
+      } else {
+        processSubBlocks<false, false>(buffer, startSample, numSamples, tap);
+      }
+    }
+  }
+
+ private:
+  struct Coefficients {
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+  };
+
+  // 2次のIIRフィルタ(転置直接形II). 状態はチャンネルごとに持つ
+  class Biquad {
+   public:
+    void prepare(std::int32_t numChannels) {
+      _states.resize((size_t)jmax(numChannels, 1));
+      reset();
+    }
+
+    void reset() {
+      for (auto& state : _states) {
+        state.s1 = 0.0f;
+        state.s2 = 0.0f;
+      }
+    }
+
+    void setCoefficients(const Coefficients& coefficients) { _c = coefficients; }
+
+    std::int32_t getNumChannels() const { return (std::int32_t)_states.size(); }
+
+    inline float processSample(std::int32_t channel, float x) {
+      auto& state = _states[(size_t)channel];
+      const auto y = _c.b0 * x + state.s1;
+      state.s1 = _c.b1 * x - _c.a1 * y + state.s2;
+      state.s2 = _c.b2 * x - _c.a2 * y;
+      return y;
+    }
+
+   private:
+    struct State {
+      float s1 = 0.0f, s2 = 0.0f;
+    };
+
+    Coefficients _c;
+    std::vector<State> _states;
+  };
+
+  // dsp::IIR::Coefficients::makeLowPass/makeHighPass と同じ係数(Q = 1/√2)
+  static Coefficients makeLowPass(double sampleRate, float frequency) {
+    const auto n = 1.0 / std::tan(MathConstants<double>::pi * frequency / sampleRate);
+    const auto invQ = MathConstants<double>::sqrt2;
+    const auto c1 = 1.0 / (1.0 + invQ * n + n * n);
+
+    Coefficients c;
+    c.b0 = (float)c1;
+    c.b1 = (float)(c1 * 2.0);
+    c.b2 = (float)c1;
+    c.a1 = (float)(c1 * 2.0 * (1.0 - n * n));
+    c.a2 = (float)(c1 * (1.0 - invQ * n + n * n));
+    return c;
+  }
+
+  static Coefficients makeHighPass(double sampleRate, float frequency) {
+    const auto n = std::tan(MathConstants<double>::pi * frequency / sampleRate);
+    const auto invQ = MathConstants<double>::sqrt2;
+    const auto c1 = 1.0 / (1.0 + invQ * n + n * n);
+
+    Coefficients c;
+    c.b0 = (float)c1;
+    c.b1 = (float)(c1 * -2.0);
+    c.b2 = (float)c1;
+    c.a1 = (float)(c1 * 2.0 * (n * n - 1.0));
+    c.a2 = (float)(c1 * (1.0 - invQ * n + n * n));
+    return c;
+  }
+
+  template <bool HiCut, bool LowCut, typename TapFunction>
+  void processSubBlocks(AudioBuffer<float>& buffer, std::int32_t startSample, std::int32_t numSamples, TapFunction& tap) {
+    const auto numChannels = jmin(buffer.getNumChannels(), _hicut.getNumChannels());
+
+    for (auto offset = 0; offset < numSamples; offset += SUB_BLOCK_SIZE) {
+      const auto n = jmin(SUB_BLOCK_SIZE, numSamples - offset);
+
+      // 移動中のパラメータだけを進める. ゲインは全チャンネルで同じ値を使うため先に計算しておく
+      const auto isGainSmoothing = _gain.isSmoothing();
+      if (isGainSmoothing) {
+        for (auto i = 0; i < n; ++i) {
+          _gainRamp[i] = _gain.getNextValue();
+        }
+      }
+      const auto gain = _gain.getTargetValue();
+      if (HiCut && _hicutFreq.isSmoothing()) {
+        _hicut.setCoefficients(makeLowPass(_sampleRate, _hicutFreq.skip(n)));
+      }
+      if (LowCut && _lowcutFreq.isSmoothing()) {
+        _lowcut.setCoefficients(makeHighPass(_sampleRate, _lowcutFreq.skip(n)));
+      }
+
+      for (auto channel = 0; channel < numChannels; ++channel) {
+        auto* data = buffer.getWritePointer(channel, startSample + offset);
+
+        for (auto i = 0; i < n; ++i) {
+          auto x = data[i] * (isGainSmoothing ? _gainRamp[i] : gain);
+          if (HiCut) {
+            x = _hicut.processSample(channel, x);
+          }
+          if (LowCut) {
+            x = _lowcut.processSample(channel, x);
+          }
+          data[i] = x;
+        }
+
+        _clipper.processSamples(channel, data, n);
+      }
+
+      tap(buffer.getReadPointer(0, startSample + offset), n);
+    }
+  }
+
+  double _sampleRate = 44100.0;
+  SmoothedValue<float> _gain{1.0f};
+  // 移動中のゲイン. サブブロック1つ分
+  float _gainRamp[SUB_BLOCK_SIZE];
+
+  bool _hasParameters = false;
+  bool _isHicutEnabled = false;
+  bool _isLowcutEnabled = false;
+  // 周波数は対数で移動させる
+  SmoothedValue<float, ValueSmoothingTypes::Multiplicative> _hicutFreq{20000.0f};
+  SmoothedValue<float, ValueSmoothingTypes::Multiplicative> _lowcutFreq{40.0f};
+
+  Biquad _hicut;
+  Biquad _lowcut;
+  SoftClipper _clipper;
+};
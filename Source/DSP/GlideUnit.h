@@ -0,0 +1,74 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "ChipTypes.h"
+
+/*
+--------------------------------------------------------------------------------
+GlideUnit
+ポルタメントのピッチを対数(オクターブ)で目標の音程へ直線的に近づける.
+CONTROL_INTERVALサンプルごとに1回だけ進めてピッチの倍率を計算し, その間は同じ倍率を使う.
+CONSTANT_TIMEは音程差によらずglideTime秒で, CONSTANT_RATEは1オクターブあたりglideTime秒で移動する.
+--------------------------------------------------------------------------------
+*/
+class GlideUnit {
+ public:
+  static constexpr std::int32_t CONTROL_INTERVAL = 32;
+
+  void setParameters(GLIDE_MODE_TYPE mode, float glideTime) {
+    _mode = mode;
+    _glideTime = glideTime;
+  }
+
+  void setSampleRate(double sampleRate) { _controlRate = (float)(sampleRate / CONTROL_INTERVAL); }
+
+  // 目標の音程(オクターブ)を設定する. isGlidingがfalseか前の音程がなければ直ちに移動する
+  void setTarget(float pitch, bool isGliding) {
+    _targetPitch = pitch;
+    if (!isGliding || !_hasPitch || _glideTime <= 0.0f) {
+      _currentPitch = pitch;
+      _step = 0.0f;
+    } else {
+      const auto distance = std::abs(_targetPitch - _currentPitch);
+      const auto seconds = _mode == GLIDE_MODE_TYPE::CONSTANT_TIME ? _glideTime : _glideTime * distance;
+      _step = seconds > 0.0f ? distance / (seconds * _controlRate) : distance;
+    }
+    _hasPitch = true;
+    _counter = 0;
+  }
+
+  // 前の音程を忘れる. 次のsetTargetはグライドしない
+  void reset() {
+    _hasPitch = false;
+    _step = 0.0f;
+    _currentPitch = _targetPitch;
+    _ratio = 1.0f;
+  }
+
+  // 1サンプル進め, 目標の音程に対するピッチの倍率を返す
+  float tick() {
+    if (--_counter > 0) {
+      return _ratio;
+    }
+    _counter = CONTROL_INTERVAL;
+    _ratio = std::exp2(_currentPitch - _targetPitch);
+    if (_currentPitch < _targetPitch) {
+      _currentPitch = jmin(_targetPitch, _currentPitch + _step);
+    } else {
+      _currentPitch = jmax(_targetPitch, _currentPitch - _step);
+    }
+    return _ratio;
+  }
+
+ private:
+  GLIDE_MODE_TYPE _mode = GLIDE_MODE_TYPE::CONSTANT_TIME;
+  float _glideTime = 0.0f;
+  float _controlRate = 1.0f;
+  float _currentPitch = 0.0f;
+  float _targetPitch = 0.0f;
+  // 制御周期あたりに進むオクターブ
+  float _step = 0.0f;
+  float _ratio = 1.0f;
+  bool _hasPitch = false;
+  std::int32_t _counter = 0;
+};
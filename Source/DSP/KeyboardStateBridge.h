@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "MidiEventQueue.h"
+
+/*
+--------------------------------------------------------------------------------
+KeyboardStateBridge
+オーディオスレッドとGUIのMidiKeyboardStateをロックなしでつなぐクラス.
+MidiKeyboardStateは内部でCriticalSectionを取るため, オーディオスレッドからは触らない.
+ - オーディオスレッド: 鳴っているノートを128bitのマスクとしてatomicに公開する
+ - GUIスレッド: 鍵盤で押されたノートをMidiEventQueueへ送り,
+                タイマーからsyncToKeyboardStateを呼んでマスクの変化を鍵盤の表示へ反映する
+--------------------------------------------------------------------------------
+*/
+class KeyboardStateBridge : private MidiKeyboardState::Listener {
+ public:
+  KeyboardStateBridge(MidiKeyboardState& state, MidiEventQueue& queue)
+      : keyboardState(state), eventQueue(queue) {
+    keyboardState.addListener(this);
+  }
+
+  ~KeyboardStateBridge() { keyboardState.removeListener(this); }
+
+  // オーディオスレッドから呼ぶ. MIDIバッファ中のノートオン/オフをマスクへ反映する
+  void processMidiBuffer(const MidiBuffer& midiMessages) {
+    auto low = notesLow.load(std::memory_order_relaxed);
+    auto high = notesHigh.load(std::memory_order_relaxed);
+
+    for (const auto metadata : midiMessages) {
+      const auto message = metadata.getMessage();
+      if (message.isNoteOn()) {
+        setNote(low, high, message.getNoteNumber(), true);
+      } else if (message.isNoteOff()) {
+        setNote(low, high, message.getNoteNumber(), false);
+      } else if (message.isAllNotesOff() || message.isAllSoundOff()) {
+        low = 0;
+        high = 0;
+      }
+    }
+
+    notesLow.store(low, std::memory_order_release);
+    notesHigh.store(high, std::memory_order_release);
+  }
+
+  // GUIスレッドから呼ぶ. 前回から変化したノートだけを鍵盤の表示へ反映する.
+  // GUIで押したままオーディオ側へまだ届いていないノートを消してしまわないよう, 差分だけを見る
+  void syncToKeyboardState(std::int32_t midiChannel = 1) {
+    const auto low = notesLow.load(std::memory_order_acquire);
+    const auto high = notesHigh.load(std::memory_order_acquire);
+
+    isSyncingFromAudio = true;
+    applyChanges(lastLow ^ low, low, 0, midiChannel);
+    applyChanges(lastHigh ^ high, high, 64, midiChannel);
+    isSyncingFromAudio = false;
+
+    lastLow = low;
+    lastHigh = high;
+  }
+
+  bool isNoteOn(std::int32_t noteNumber) const {
+    const auto bits = noteNumber < 64 ? notesLow.load(std::memory_order_acquire)
+                                      : notesHigh.load(std::memory_order_acquire);
+    return ((bits >> (noteNumber & 63)) & 1) != 0;
+  }
+
+ private:
+  static void setNote(std::uint64_t& low, std::uint64_t& high, std::int32_t noteNumber, bool isOn) {
+    auto& bits = noteNumber < 64 ? low : high;
+    const auto mask = (std::uint64_t)1 << (noteNumber & 63);
+    bits = isOn ? (bits | mask) : (bits & ~mask);
+  }
+
+  void applyChanges(std::uint64_t changed, std::uint64_t bits, std::int32_t firstNote, std::int32_t midiChannel) {
+    for (auto i = 0; changed != 0; ++i, changed >>= 1) {
+      if ((changed & 1) == 0) {
+        continue;
+      }
+      if ((bits >> i) & 1) {
+        keyboardState.noteOn(midiChannel, firstNote + i, 1.0f);
+      } else {
+        keyboardState.noteOff(midiChannel, firstNote + i, 0.0f);
+      }
+    }
+  }
+
+  // 鍵盤からの入力(GUIスレッド)をオーディオスレッドへ送る
+  void handleNoteOn(MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity) override {
+    if (!isSyncingFromAudio) {
+      eventQueue.push(MidiMessage::noteOn(midiChannel, midiNoteNumber, velocity));
+    }
+  }
+
+  void handleNoteOff(MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity) override {
+    if (!isSyncingFromAudio) {
+      eventQueue.push(MidiMessage::noteOff(midiChannel, midiNoteNumber, velocity));
+    }
+  }
+
+  MidiKeyboardState& keyboardState;
+  MidiEventQueue& eventQueue;
+
+  // オーディオスレッドが書き込み, GUIスレッドが読む
+  std::atomic<std::uint64_t> notesLow{0};
+  std::atomic<std::uint64_t> notesHigh{0};
+
+  // 以下はGUIスレッドからのみ触る
+  std::uint64_t lastLow = 0;
+  std::uint64_t lastHigh = 0;
+  bool isSyncingFromAudio = false;
+};
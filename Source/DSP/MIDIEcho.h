@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <atomic>
 #include <vector>
 
 class EchoBuffer {
@@ -11,35 +13,43 @@ class EchoBuffer {
 
   ~EchoBuffer(){};
 
+  // 先頭から書き直す. バッファは消さず, 1周目に書き込むまでは無音として扱う.
+  // オーディオスレッドから呼ばれるため, 確保や全体の書き換えはしない.
+  // 確保済みの長さに収まらない間は, 収まる長さまで短くして鳴らす
   void init() {
+    ++numInits;
     index = 0;
+    numWritten = 0;
     bufSize = (int)(sampleRate * echoTime);
+    if (echoCount > 0) {
+      bufSize = std::min(bufSize, capacity / echoCount);
+    }
 
     if (bufSize <= 0) {
       bufSize = 0;
     }
-
-    buf.resize(echoCount);
-
-    for (int i = 0; i < echoCount; ++i) {
-      buf[i].resize(bufSize);
-    }
-
-    for (int i = 0; i < echoCount; ++i) {
-      for (int j = 0; j < bufSize; ++j) {
-        buf[i][j] = 0.0f;
-      }
-    }
   }
 
   void addSample(float val, float amp) {
+    // バッファを受け取るまでは鳴らさない
+    if (bufSize == 0) {
+      return;
+    }
     if (index >= bufSize) {
       init();
     }
-    for (int i = echoCount - 1; i > 0; --i) {
-      buf[i][index] = buf[i - 1][index] * amp;
+    // 1周目は前のリピートに何も入っていないため, 無音を書き込む
+    if (index >= numWritten) {
+      for (int i = echoCount - 1; i > 0; --i) {
+        buf[i * bufSize + index] = 0.0f;
+      }
+      numWritten = index + 1;
+    } else {
+      for (int i = echoCount - 1; i > 0; --i) {
+        buf[i * bufSize + index] = buf[(i - 1) * bufSize + index] * amp;
+      }
     }
-    buf[0][index] = val * amp;
+    buf[index] = val * amp;
   };
 
   float getSample(int repeatCount) {
@@ -48,22 +58,92 @@ class EchoBuffer {
       return 0.0f;
     }
 
+    if (bufSize == 0) {
+      return 0.0f;
+    }
+
     if (index >= bufSize) {
       init();
       return 0.0f;
     }
 
-    return buf[repeatCount][index];
+    // まだ書き込んでいない位置には前の設定の値が残っている
+    if (index >= numWritten) {
+      return 0.0f;
+    }
+
+    return buf[repeatCount * bufSize + index];
   };
 
-  void updateParam(float sec, int count) {
+  // 先頭から書き直した場合はtrueを返す
+  bool updateParam(float sec, int count) {
     if (echoTime != sec || echoCount != count) {
       echoTime = sec;
       echoCount = count;
       init();
+      return true;
+    }
+    return false;
+  }
+
+  // ボイスのサンプルレートを設定する. バッファはprepareで確保し直す
+  void setSampleRate(int freq) {
+    if (sampleRate != freq) {
+      sampleRate = freq;
+      init();
+    }
+  }
+
+  // 指定した長さと回数のエコーが入る大きさで確保し直す. 大きさが変わらなければ何もしない.
+  // オーディオスレッドが止まっているとき(prepareToPlay)に呼ぶ
+  void prepare(float sec, int count) {
+    acquireBuffer();
+    std::vector<float>().swap(buffers[1 - active]);
+
+    const auto numSamples = getRequiredSize(sec, count);
+    if (numSamples == capacity) {
+      return;
+    }
+    std::vector<float>((size_t)numSamples).swap(buffers[active]);
+    buf = buffers[active].data();
+    capacity = numSamples;
+    init();
+  }
+
+  // 足りなければ, 使っていない方のバッファを大きく確保してオーディオスレッドへ渡す.
+  // オーディオスレッド以外から, 再生中に呼ぶ. 前に渡したバッファを受け取るまでは何もしない
+  void reserve(float sec, int count) {
+    if (hasPending.load(std::memory_order_acquire)) {
+      return;
+    }
+    const auto numSamples = getRequiredSize(sec, count);
+    auto& spare = buffers[1 - active];
+    if (numSamples <= (int)buffers[active].size()) {
+      // 入れ替え前の古いバッファを解放する
+      std::vector<float>().swap(spare);
+      return;
     }
+    std::vector<float>((size_t)numSamples).swap(spare);
+    hasPending.store(true, std::memory_order_release);
   }
 
+  // reserveで渡されたバッファに切り替える. オーディオスレッドからサブブロックごとに呼ぶ.
+  // 切り替えた場合は先頭から書き直してtrueを返す
+  bool acquireBuffer() {
+    if (!hasPending.load(std::memory_order_acquire)) {
+      return false;
+    }
+    active = 1 - active;
+    buf = buffers[active].data();
+    capacity = (int)buffers[active].size();
+    hasPending.store(false, std::memory_order_release);
+    init();
+    return true;
+  }
+
+  // これまでに先頭から書き直した回数(トレース用)
+  int getNumInits() const { return numInits; }
+
   void cycle() {
     index += 1;
     if (index >= bufSize) {
@@ -72,11 +152,25 @@ class EchoBuffer {
   }
 
  private:
-  std::vector<std::vector<float>> buf;
+  int getRequiredSize(float sec, int count) const {
+    return std::max(0, (int)(sampleRate * sec) * count);
+  }
+
+  // echoCount個のバッファを, 1つあたりbufSizeサンプルずつ並べる.
+  // 使っている方(active)と, reserveで大きく確保してオーディオスレッドへ渡す方の2つを持つ
+  std::vector<float> buffers[2];
+  int active = 0;
+  std::atomic<bool> hasPending{false};
+  // オーディオスレッドが使っているバッファとその長さ
+  float* buf = nullptr;
+  int capacity = 0;
   int sampleRate;
   int echoCount;
   float echoTime;
 
   int bufSize;
   int index;
+  // 先頭から書き直してから書き込んだサンプル数. 1周するとbufSizeになる
+  int numWritten = 0;
+  int numInits = 0;
 };
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/*
+--------------------------------------------------------------------------------
+MacroClock
+ビブラート / スイープ / 音色エンベロープ / 波形パターンなどのマクロを進めるフレームの境界を数える.
+NTSC(60Hz)やPAL(50Hz)の音源ドライバのように, マクロはフレームごとに1回だけ更新し,
+サンプルごとの処理は整数のカウンタを減らすだけにする.
+1フレームのサンプル数の端数は持ち越すため, 長く鳴らしてもフレームの周期がずれない.
+フレームレートをサンプルレートと同じにすると, 毎サンプルがフレームの境界になる.
+--------------------------------------------------------------------------------
+*/
+class MacroClock {
+ public:
+  void setRate(double sampleRate, double frameRate) {
+    _samplesPerFrame = jmax(1.0, sampleRate / jmax(1.0, frameRate));
+  }
+
+  // 次のtickをフレームの境界にする. 発音開始時に呼ぶ
+  void reset() {
+    _counter = 0;
+    _fraction = 0.0;
+  }
+
+  // 1サンプル進める. フレームの境界ならtrue
+  bool tick() {
+    if (--_counter > 0) {
+      return false;
+    }
+    const auto samples = _samplesPerFrame + _fraction;
+    _counter = (std::int32_t)samples;
+    _fraction = samples - _counter;
+    return true;
+  }
+
+ private:
+  double _samplesPerFrame = 1.0;
+  double _fraction = 0.0;
+  std::int32_t _counter = 0;
+};
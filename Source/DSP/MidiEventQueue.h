@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/*
+--------------------------------------------------------------------------------
+MidiEventQueue
+GUIなど別スレッドからオーディオスレッドへMIDIイベントを渡すための固定長キュー.
+書き込み側1スレッド, 読み出し側1スレッドを前提に AbstractFifo でロックなしに受け渡す.
+イベントは3バイトまでの短いメッセージのみ扱い, キューが一杯のときは捨てる.
+--------------------------------------------------------------------------------
+*/
+class MidiEventQueue {
+ public:
+  static constexpr std::int32_t CAPACITY = 512;
+  static constexpr std::int32_t MAX_MESSAGE_BYTES = 3;
+  // MidiBufferはイベントごとに時刻(int32)とサイズ(uint16)をデータの前に置く.
+  // 一杯のキューを取り出しても確保し直さないためのバイト数
+  static constexpr std::size_t MIDI_BUFFER_BYTES =
+      (std::size_t)CAPACITY * (sizeof(int32) + sizeof(uint16) + MAX_MESSAGE_BYTES);
+
+  MidiEventQueue(){};
+
+  // 書き込み側のスレッドから呼ぶ. sampleOffsetは次に処理するブロック先頭からの位置
+  bool push(const MidiMessage& message, std::int32_t sampleOffset = 0) {
+    const auto numBytes = message.getRawDataSize();
+    if (numBytes <= 0 || numBytes > MAX_MESSAGE_BYTES) {
+      return false;
+    }
+
+    int start1, size1, start2, size2;
+    abstractFifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 <= 0) {
+      return false;
+    }
+
+    auto& event = events[(size_t)start1];
+    std::memcpy(event.data, message.getRawData(), (size_t)numBytes);
+    event.numBytes = numBytes;
+    event.sampleOffset = sampleOffset;
+
+    abstractFifo.finishedWrite(1);
+    return true;
+  }
+
+  // 読み出し側(オーディオスレッド)から呼ぶ. 溜まっているイベントを全てdestinationへ追加する.
+  // 時刻は [0, numSamples) に収める. destinationは事前にMIDI_BUFFER_BYTESだけensureSizeで確保しておくこと
+  void popAllInto(MidiBuffer& destination, std::int32_t numSamples) {
+    int start1, size1, start2, size2;
+    abstractFifo.prepareToRead(abstractFifo.getNumReady(), start1, size1, start2, size2);
+
+    addEvents(destination, start1, size1, numSamples);
+    addEvents(destination, start2, size2, numSamples);
+
+    abstractFifo.finishedRead(size1 + size2);
+  }
+
+  void reset() { abstractFifo.reset(); }
+
+ private:
+  struct Event {
+    std::uint8_t data[MAX_MESSAGE_BYTES];
+    std::int32_t numBytes;
+    std::int32_t sampleOffset;
+  };
+
+  void addEvents(MidiBuffer& destination, int start, int size, std::int32_t numSamples) {
+    const auto lastSample = jmax(numSamples - 1, 0);
+    for (auto i = start; i < start + size; ++i) {
+      const auto& event = events[(size_t)i];
+      destination.addEvent(event.data, event.numBytes, jlimit(0, lastSample, event.sampleOffset));
+    }
+  }
+
+  std::array<Event, CAPACITY> events;
+  AbstractFifo abstractFifo{CAPACITY};
+};
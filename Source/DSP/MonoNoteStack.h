@@ -0,0 +1,112 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "ChipTypes.h"
+
+/*
+--------------------------------------------------------------------------------
+MonoNoteStack
+モノフォニックで押されているノートを保持する. ノート番号ごとの固定長の双方向リストで押した順を,
+ビット列で音程の順を持つため, ノートオン/オフと優先するノートの検索はどれも定数時間で済み, 確保もしない.
+--------------------------------------------------------------------------------
+*/
+class MonoNoteStack {
+ public:
+  static constexpr std::int32_t NUM_OF_NOTES = 128;
+
+  MonoNoteStack() { clear(); }
+
+  void clear() {
+    _last = NONE;
+    std::fill(std::begin(_prev), std::end(_prev), (std::int32_t)NONE);
+    std::fill(std::begin(_next), std::end(_next), (std::int32_t)NONE);
+    std::fill(std::begin(_velocities), std::end(_velocities), 0.0f);
+    std::fill(std::begin(_heldBits), std::end(_heldBits), 0u);
+  }
+
+  bool isEmpty() const { return _last == NONE; }
+
+  bool isHeld(std::int32_t note) const {
+    return isValidNote(note) && ((_heldBits[note / BITS_PER_WORD] >> (note % BITS_PER_WORD)) & 1u);
+  }
+
+  // 押されたノートを最後に押したノートにする. すでに押されていれば順番だけ入れ替える
+  void noteOn(std::int32_t note, float velocity) {
+    if (!isValidNote(note)) {
+      return;
+    }
+    if (isHeld(note)) {
+      unlink(note);
+    }
+    _prev[note] = _last;
+    _next[note] = NONE;
+    if (_last != NONE) {
+      _next[_last] = note;
+    }
+    _last = note;
+    _velocities[note] = velocity;
+    _heldBits[note / BITS_PER_WORD] |= 1u << (note % BITS_PER_WORD);
+  }
+
+  void noteOff(std::int32_t note) {
+    if (!isHeld(note)) {
+      return;
+    }
+    unlink(note);
+    _heldBits[note / BITS_PER_WORD] &= ~(1u << (note % BITS_PER_WORD));
+  }
+
+  // 優先度に従って鳴らすノート. 何も押されていなければ-1
+  std::int32_t getNote(NOTE_PRIORITY_TYPE priority) const {
+    switch (priority) {
+      case NOTE_PRIORITY_TYPE::LOW:
+        for (auto word = 0; word < NUM_OF_WORDS; ++word) {
+          if (_heldBits[word] != 0) {
+            const auto bits = _heldBits[word];
+            return word * BITS_PER_WORD + findHighestSetBit(bits & (~bits + 1u));
+          }
+        }
+        return NONE;
+      case NOTE_PRIORITY_TYPE::HIGH:
+        for (auto word = NUM_OF_WORDS; --word >= 0;) {
+          if (_heldBits[word] != 0) {
+            return word * BITS_PER_WORD + findHighestSetBit(_heldBits[word]);
+          }
+        }
+        return NONE;
+      default:
+        return _last;
+    }
+  }
+
+  float getVelocity(std::int32_t note) const { return isValidNote(note) ? _velocities[note] : 0.0f; }
+
+ private:
+  static constexpr std::int32_t NONE = -1;
+  static constexpr std::int32_t BITS_PER_WORD = 32;
+  static constexpr std::int32_t NUM_OF_WORDS = NUM_OF_NOTES / BITS_PER_WORD;
+
+  static bool isValidNote(std::int32_t note) { return note >= 0 && note < NUM_OF_NOTES; }
+
+  void unlink(std::int32_t note) {
+    const auto prev = _prev[note];
+    const auto next = _next[note];
+    if (prev != NONE) {
+      _next[prev] = next;
+    }
+    if (next != NONE) {
+      _prev[next] = prev;
+    } else {
+      _last = prev;
+    }
+    _prev[note] = NONE;
+    _next[note] = NONE;
+  }
+
+  // 最後に押したノート
+  std::int32_t _last;
+  std::int32_t _prev[NUM_OF_NOTES];
+  std::int32_t _next[NUM_OF_NOTES];
+  float _velocities[NUM_OF_NOTES];
+  uint32 _heldBits[NUM_OF_WORDS];
+};
@@ -14,7 +14,12 @@ SimpleVoice::SimpleVoice(
   OptionsParameters* optionsParams, 
   MidiEchoParameters* midiEchoParams,
   WaveformMemoryParameters* waveformMemoryParams,
-  WavePatternParameters* wavePatternParams)
+  WavePatternParameters* wavePatternParams,
+  VoiceFilterParameters* voiceFilterParams,
+  VoiceFilterBank* voiceFilterBank,
+  const ColorTableBank* colorTableBank,
+  const VoiceParameterSnapshot* parameterSnapshot,
+  std::int32_t voiceIndex)
   : _chipOscParamsPtr(chipOscParams),
     _sweepParamsPtr(sweepParams),
     _vibratoParamsPtr(vibratoParams),
@@ -23,12 +28,18 @@ SimpleVoice::SimpleVoice(
     _midiEchoParamsPtr(midiEchoParams),
     _waveformMemoryParamsPtr(waveformMemoryParams),
     _wavePatternParams(wavePatternParams),
+    _voiceFilterParamsPtr(voiceFilterParams),
+    _parameterSnapshot(parameterSnapshot),
+    _waveKernel(parameterSnapshot->waveKernel),
+    _voiceFilterBank(voiceFilterBank),
+    _voiceIndex(voiceIndex),
     ampEnv(chipOscParams->Attack->get(), chipOscParams->Decay->get(),
             chipOscParams->Sustain->get(), chipOscParams->Release->get(),
             midiEchoParams->EchoDuration->get() * midiEchoParams->EchoRepeat->get()),
     vibratoEnv(vibratoParams->VibratoAttackTime->get(), 0.1f, 1.0f, 0.1f, 0.0f),
-    portaEnv(voicingParams->StepTime->get(), 0.0f, 1.0f, 0.0f, 0.0f),
-    colorEnv(chipOscParams),
+    filterEnv(voiceFilterParams->Attack->get(), voiceFilterParams->Decay->get(),
+              voiceFilterParams->Sustain->get(), voiceFilterParams->Release->get(), 0.0f),
+    colorEnv(chipOscParams, colorTableBank),
     eb((std::int32_t)getSampleRate(),
         (float)midiEchoParams->EchoDuration->get(),
       midiEchoParams->EchoRepeat->get()) {
@@ -45,39 +56,64 @@ void SimpleVoice::startNote(int midiNoteNumber, float velocity,
   DBG("[StartNote] NoteNumber: " + juce::String(midiNoteNumber) +
       ", Velocity: " + juce::String(velocity));
 
-  if (!canStartNote()) {
+  const auto isLegatoNote = _isStolenWhileHolding;
+  _isStolenWhileHolding = false;
+  if (!isLegatoNote && !canStartNote()) {
     return;
   }
+  SANA_TRACE_INSTANT(_traceRecorder, "startNote", TraceRecorder::VOICE_TRACK_OFFSET + _voiceIndex,
+                     (float)midiNoteNumber, velocity);
   SimpleSound* soundForPlay = dynamic_cast<SimpleSound*>(sound);
   if (soundForPlay == nullptr) {
     return;
   }
+
+  // 生成する波形のピッチを再現するサンプルデータ間の角度差⊿θ[rad]の値を決定する。
+  float cyclesPerSecond = (float)MidiMessage::getMidiNoteInHertz(
+      midiNoteNumber, _optionsParamsPtr->PitchStandard->get());
+  float cyclesPerSample = (float)cyclesPerSecond / (float)getSampleRate();
+
+  // ポルタメントは前の音を押したまま弾いたときだけ, 前の音程からグライドする
+  const auto isPortaMode = (toChipType<VOICING_TYPE>(_voicingParamsPtr->VoicingSwitch) == VOICING_TYPE::PORTAMENTO);
+  glide.setParameters(toChipType<GLIDE_MODE_TYPE>(_voicingParamsPtr->GlideMode), _voicingParamsPtr->StepTime->get());
+  glide.setSampleRate(getSampleRate());
+  glide.setTarget(std::log2(cyclesPerSecond), isLegatoNote && isPortaMode);
+
+  // レガートではエンベロープや位相をかけ直さず, 音程と音量だけを切り替える
+  if (isLegatoNote && isLegatoEnabled()) {
+    angleDelta = cyclesPerSample * TWO_PI;
+    level = std::max(0.01f, velocity) * 0.8f;
+    pitchBend = ((float)currentPitchWheelPosition - 8192.0f) / 8192.0f;
+    return;
+  }
+
+  // 無音状態から発音する場合のみフィルタの状態を初期化する
+  if (ampEnv.isReleaseEnded() || ampEnv.isEchoEnded()) {
+    _voiceFilterBank->resetLane(_voiceIndex);
+  }
   clear();
 
-  eb.updateParam(_midiEchoParamsPtr->EchoDuration->get(),
-                 _midiEchoParamsPtr->EchoRepeat->get());
+  eb.updateParam(_parameterSnapshot->echoDuration, _parameterSnapshot->echoRepeat);
+  traceEchoBufferInits();
 
   velocity = std::max(0.01f, velocity);
   level = velocity * 0.8f;
 
   pitchBend = ((float)currentPitchWheelPosition - 8192.0f) / 8192.0f;
 
-  // 生成する波形のピッチを再現するサンプルデータ間の角度差⊿θ[rad]の値を決定する。
-  float cyclesPerSecond = (float)MidiMessage::getMidiNoteInHertz(
-      midiNoteNumber, _optionsParamsPtr->PitchStandard->get());
-  float cyclesPerSample = (float)cyclesPerSecond / (float)getSampleRate();
   angleDelta = cyclesPerSample * TWO_PI;
 
+  vibratoAmount.setCurrentAndTargetValue(_parameterSnapshot->vibratoAmount);
   ampEnv.attackStart();
   vibratoEnv.attackStart();
-  portaEnv.attackStart();
+  filterEnv.attackStart();
   colorEnv.clear();
   patternWaveClear();
+  macroClock.reset();
 
   // 波形パターン初期設定
-  if (_wavePatternParams->PatternEnabled->get()) {
-    const auto waveType = _wavePatternParams->WaveTypes[0]->getIndex();
-    *(_chipOscParamsPtr->OscWaveType) = waveType;
+  if (_parameterSnapshot->isPatternEnabled) {
+    setWaveType(_wavePatternParams->WaveTypes[0]->getIndex());
   }
 }
 
@@ -85,24 +121,30 @@ void SimpleVoice::startNote(int midiNoteNumber, float velocity,
 /// キーリリース直後のボイススチールではallowTailOff == false
 void SimpleVoice::stopNote(float /*velocity*/, bool allowTailOff) {
   DBG("stopNote : " + juce::String((std::int32_t)allowTailOff));
+  // allowTailOff == false はボイススチール(またはallNotesOff)
+  SANA_TRACE_INSTANT(_traceRecorder, allowTailOff ? "stopNote" : "steal",
+                     TraceRecorder::VOICE_TRACK_OFFSET + _voiceIndex, (float)getCurrentlyPlayingNote(), 0.0f);
   
   if (allowTailOff) {
-    portaAngleDelta = 0.0f;
     ampEnv.releaseStart();
+    filterEnv.releaseStart();
     return;
   }
   // キーホールド中(ADSのいずれか)であればangleDeltaをリリース状態に移行
   if (ampEnv.isHolding()) {
-    //ポルタメント処理，一つ前のピッチを記憶しておく
-    portaAngleDelta = angleDelta;
+    // 直後のstartNoteで前の音程からのポルタメントやレガートを行う
+    _isStolenWhileHolding = true;
+    // レガートではエンベロープを続ける. startNoteが来なかった場合はrenderNextBlockでリリースする
+    if (isLegatoEnabled()) {
+      return;
+    }
 
     // NOTE: ボイススチールを受けて直ぐに音量を0にしてしまうと、急峻な変化となりノイズの発生を引き起こすため、それを予防する処理。
     ampEnv.releaseStart();
+    filterEnv.releaseStart();
     return;
   }
 
-  portaAngleDelta = 0.0f;
-
   clear();
   clearCurrentNote();
 }
@@ -116,144 +158,191 @@ void SimpleVoice::controllerMoved(int /*controllerNumber*/,
 
 void SimpleVoice::renderNextBlock(AudioBuffer<float>& outputBuffer,
                                   int startSample, int numSamples) {
-  // 現状のパラメータを取得しておく
-  // NOTE: 適宜取得すると何度も取得関数が走るため重くなる
-  auto currentWaveName = _chipOscParamsPtr->OscWaveType->getCurrentChoiceName();
-  auto isEchoEnabled = _midiEchoParamsPtr->IsEchoEnable->get();
-  auto echoRepeatCount = _midiEchoParamsPtr->EchoRepeat->get();
-  auto isVibratoEnabled = _vibratoParamsPtr->VibratoEnable->get();
-  auto isInVibratoDelay = 
-    (_vibratoParamsPtr->VibratoAttackDeleySwitch->get() == false) &&
-     (vibratoEnv.getState() == AmpEnvelope::AMPENV_STATE::ATTACK);
-  auto vibratoSpeed = _vibratoParamsPtr->VibratoSpeed->get();
-  auto pitchBendRange = _optionsParamsPtr->PitchBendRange->get();
-  auto isPortaMode = (_voicingParamsPtr->VoicingSwitch->getCurrentChoiceName() == "PORTAMENTO");
-  auto isPositiveSweepEnbaled = (_sweepParamsPtr->SweepSwitch->getCurrentChoiceName() == "Positive");
-  auto isNegativeSweepEnbaled = (_sweepParamsPtr->SweepSwitch->getCurrentChoiceName() == "Negative");
-  auto sweepTime = (float)_sweepParamsPtr->SweepTime->get();
-  auto isPatternWaveEnabled = (float)_wavePatternParams->PatternEnabled->get();
-  auto isPatternLoopEnabled = (float)_wavePatternParams->LoopEnabled->get();
-  patternStepNum = (float)_wavePatternParams->StepTime->get() * getSampleRate();
-
-  SimpleSound* playingSound =  static_cast<SimpleSound*>(getCurrentlyPlayingSound().get());
+  // ボイスは常に最大数だけ用意してあるため, 発音していないボイスはパラメータを読む前に抜ける
+  SimpleSound* playingSound = static_cast<SimpleSound*>(getCurrentlyPlayingSound().get());
   if (playingSound == nullptr) {
-    clear();
     return;
   }
 
-  updateEnvParams(ampEnv, vibratoEnv, portaEnv);
-  eb.updateParam(_midiEchoParamsPtr->EchoDuration->get(), _midiEchoParamsPtr->EchoRepeat->get());
-
-  while (--numSamples >= 0) {
-    // エンベロープにおいて，エフェクトエコーが終わっている or
-    // リリース状態のとき
-    if ((ampEnv.isReleaseEnded()) ||
-        (isEchoEnabled && ampEnv.isEchoEnded())) {
-      clearCurrentNote();
-      clear();
-      break;
-    }
+  SANA_TRACE_SCOPE(_traceRecorder, "Voice::renderNextBlock", TraceRecorder::VOICE_TRACK_OFFSET + _voiceIndex);
 
-    // 現在のサンプル値を計算する
-    auto currentSample = angle2wave(currentAngle, angleDelta, currentWaveName);
-    currentSample *= ampEnv.getValue() * level;
-
-    //エコー処理とエコーレンダリング
-    if (isEchoEnabled) {
-      eb.addSample(currentSample, _midiEchoParamsPtr->VolumeOffset->get() / 100.0f);
-      eb.cycle();
+  // パラメータはプロセッサがサブブロックごとに読み込んだスナップショットから取る.
+  // MIDIイベントでレンダリングが区切られても, パラメータを読み直したりエンベロープを設定し直したりしない
+  applyParameterSnapshot();
+  // エコーのバッファが大きく確保し直されていれば切り替える
+  if (eb.acquireBuffer()) {
+    traceEchoBufferInits();
+  }
+  const auto& params = *_parameterSnapshot;
+  auto isEchoEnabled = params.isEchoEnabled;
+  auto echoRepeatCount = params.echoRepeat;
+  auto isVibratoEnabled = params.isVibratoEnabled;
+  auto isInVibratoDelay =
+    (params.isVibratoAttackDelayEnabled == false) &&
+     (vibratoEnv.getState() == AmpEnvelope::AMPENV_STATE::ATTACK);
+  auto vibratoSpeed = params.vibratoSpeed;
+  auto pitchBendRange = params.pitchBendRange;
+  auto isPositiveSweepEnbaled = (params.sweepType == SWEEP_TYPE::POSITIVE);
+  auto isNegativeSweepEnbaled = (params.sweepType == SWEEP_TYPE::NEGATIVE);
+  auto sweepTime = params.sweepTime;
+  auto isPatternWaveEnabled = params.isPatternEnabled;
+  auto isPatternLoopEnabled = params.isPatternLoopEnabled;
+  const auto frameRate = params.frameRate;
+  auto isVoiceFilterEnabled = _voiceFilterBank->isEnabled();
+  auto filterEnvAmount = params.filterEnvAmount;
+  // キートラッキング: C4(60)を基準にノート番号に応じてカットオフをオクターブ単位でずらす
+  auto keyTrackOctave = (getCurrentlyPlayingNote() - 60) / 12.0f * params.filterKeyTrack;
+
+  // allNotesOffなど, ボイススチールの後にstartNoteが来なかった
+  if (_isStolenWhileHolding) {
+    _isStolenWhileHolding = false;
+    ampEnv.releaseStart();
+    filterEnv.releaseStart();
+  }
 
-      for (auto channelNum = outputBuffer.getNumChannels(); --channelNum >= 0;) {
-        for (auto i = 0; i < echoRepeatCount; ++i) {
-          outputBuffer.addSample(channelNum, startSample, eb.getSample(i));
+  // ピッチベンドはMIDIイベントの位置でレンダリングが区切られるため, 呼び出しごとに1回計算すればよい
+  const auto pitchBendFactor = pow(2.0f, pitchBend / 13.0f * pitchBendRange);
+
+  while (numSamples > 0) {
+    // エンベロープはENVELOPE_BUFFER_SIZEずつまとめて計算する.
+    // アンプエンベロープがリリース(またはエコー)を終えたサンプル以降は処理しない
+    const auto chunkSize = jmin(ENVELOPE_BUFFER_SIZE, numSamples);
+    const auto activeSamples = ampEnv.renderBlock(ampValues, chunkSize);
+    filterEnv.renderBlock(filterValues, activeSamples);
+    numSamples -= chunkSize;
+
+    for (auto sampleIndex = 0; sampleIndex < activeSamples; ++sampleIndex) {
+      // 現在のサンプル値を計算する
+      auto currentSample = _waveKernel(waveForms, currentAngle, angleDelta, _waveformMemoryParamsPtr);
+      currentSample *= ampValues[sampleIndex] * level;
+
+      //エコー処理とエコーレンダリング
+      if (isEchoEnabled) {
+        eb.addSample(currentSample, params.echoVolume);
+        eb.cycle();
+
+        if (isVoiceFilterEnabled) {
+          for (auto i = 0; i < echoRepeatCount; ++i) {
+            _voiceFilterBank->addSample(_voiceIndex, startSample, eb.getSample(i));
+          }
+        } else {
+          for (auto channelNum = outputBuffer.getNumChannels(); --channelNum >= 0;) {
+            for (auto i = 0; i < echoRepeatCount; ++i) {
+              outputBuffer.addSample(channelNum, startSample, eb.getSample(i));
+            }
+          }
         }
       }
-    }
 
-    // バッファ書き込み
-    for (auto channelNum = outputBuffer.getNumChannels(); --channelNum >= 0;) {
-      outputBuffer.addSample(channelNum, startSample, currentSample);
-    }
-    ++startSample;
+      // バッファ書き込み
+      // ボイスフィルタが有効な場合はフィルタのレーンに書き込み, 後でまとめてフィルタ処理する
+      if (isVoiceFilterEnabled) {
+        _voiceFilterBank->addSample(_voiceIndex, startSample, currentSample);
+        _voiceFilterBank->setCutoffOffset(_voiceIndex, startSample,
+                                          keyTrackOctave + filterEnvAmount * filterValues[sampleIndex]);
+      } else {
+        for (auto channelNum = outputBuffer.getNumChannels(); --channelNum >= 0;) {
+          outputBuffer.addSample(channelNum, startSample, currentSample);
+        }
+      }
+      ++startSample;
+
+      //NOTE: 以降はサイクル更新処理を行う
+
+      // フレームの境界でマクロ(ビブラート, スイープ, 音色エンベロープ, 波形パターン)を1フレーム分進める
+      if (macroClock.tick()) {
+        // Vibratoのモジュレーション影響度計算
+        float modulationFactor = 0.0f;
+        if (!(isVibratoEnabled) || isInVibratoDelay) {
+          modulationFactor = 0.0f;
+        } else {
+          modulationFactor = calcModulationFactor(vibratoAngle) * vibratoEnv.getValue();
+        }
 
-    //NOTE: 以降はサイクル更新処理を行う
+        // 次のフレームまで使うピッチの倍率
+        const auto pitchModulationFactor = pow(2.0f, modulationFactor / 13.0f);
+        const auto sweepFactor = pow(2.0f, pitchSweep);
+        macroPitchFactor = pitchModulationFactor * sweepFactor * colorEnv.getRatio();
+
+        // ビブラート更新
+        vibratoAngle = fmod(vibratoAngle + vibratoSpeed / frameRate * TWO_PI, TWO_PI);
+
+        // スイープ更新
+        if (isPositiveSweepEnbaled) {
+          pitchSweep += 1 / frameRate / sweepTime;
+          pitchSweep = std::min(10.0f, pitchSweep);
+        } else if (isNegativeSweepEnbaled) {
+          pitchSweep -= 1 / frameRate / sweepTime;
+          pitchSweep = std::max(-10.0f, pitchSweep);
+        }
 
-    // Vibratoのモジュレーション影響度計算
-    float modulationFactor = 0.0f;
-    if (!(isVibratoEnabled) || isInVibratoDelay) {
-      modulationFactor = 0.0f;
-    } else {
-      modulationFactor = calcModulationFactor(vibratoAngle) *  vibratoEnv.getValue();
-    }
+        // パターンエンベロープ
+        if (isPatternWaveEnabled) {
+          patternCounter++;
+
+          // パターン更新処理
+          if (patternCounter >= patternStepNum) {
+            patternCounter = 0;
+
+            patternIndex++;
+            if (patternIndex >= WAVEPATTERN_LENGTH) {
+              if (isPatternLoopEnabled) {
+                patternIndex = 0;
+              } else {
+                patternIndex = WAVEPATTERN_LENGTH - 1;
+              }
+            }
+            const auto nextIndex = (WAVEPATTERN_TYPES - 1) - _wavePatternParams->WavePatternArray[patternIndex]->get();
+            setWaveType(_wavePatternParams->WaveTypes[nextIndex]->getIndex());
+          }
+        }
 
-    //ピッチ処理
-    const auto pitchBendFactor = pow(2.0f, pitchBend / 13.0f * pitchBendRange);
-    const auto pitchModulationFactor = pow(2.0f, modulationFactor / 13.0f);
-    const auto sweepFactor = pow(2.0f, pitchSweep);
-    const auto colorFactor = colorEnv.getManipulateAngle() + 1;
-    currentAngle += angleDelta * pitchBendFactor * pitchModulationFactor * sweepFactor * colorFactor;
-
-    // ポルタメントをcurrentAngleに反映
-    if (isPortaMode) {
-      if (portaAngleDelta > 0.0f) {
-        currentAngle -= (angleDelta - portaAngleDelta) * (1 - portaEnv.getValue());
+        vibratoEnv.cycle();
+        colorEnv.cycle();
       }
-    }
 
-    // ビブラート更新
-    vibratoAngle += ((vibratoSpeed) / (float)getSampleRate()) * TWO_PI;
+      //ピッチ処理. ポルタメントの倍率はGlideUnit::CONTROL_INTERVALごとに更新される
+      currentAngle += angleDelta * pitchBendFactor * macroPitchFactor * glide.tick();
 
-    // スイープ更新
-    if (isPositiveSweepEnbaled) {
-      pitchSweep += 1 / (float)getSampleRate() / sweepTime;
-      pitchSweep = std::min(10.0f, pitchSweep);
-    } else if (isNegativeSweepEnbaled) {
-      pitchSweep -= 1 / (float)getSampleRate() / sweepTime;
-      pitchSweep = std::max(-10.0f, pitchSweep);
+      // 周期切り捨て
+      currentAngle = fmod(currentAngle, TWO_PI);
     }
 
-    // パターンエンベロープ
-    if (isPatternWaveEnabled) {
-      patternCounter++;
-
-      // パターン更新処理
-      if (patternCounter >= patternStepNum) {
-        patternCounter = 0;
+    // ビブラートの深さはフレームの長さによらず, チャンクごとにサンプル数分だけ目標へ近づける
+    if (vibratoAmount.isSmoothing()) {
+      vibratoAmount.skip(chunkSize);
+    }
 
-        patternIndex++;
-        if (patternIndex >= WAVEPATTERN_LENGTH) {
-          if (isPatternLoopEnabled) {
-            patternIndex = 0;
-          } else {
-            patternIndex = WAVEPATTERN_LENGTH - 1;
-          }
-        }
-        const auto nextIndex = (WAVEPATTERN_TYPES - 1) - _wavePatternParams->WavePatternArray[patternIndex]->get();
-        const auto waveType = _wavePatternParams->WaveTypes[nextIndex]->getIndex();
-        *(_chipOscParamsPtr->OscWaveType) = waveType;
-      }
+    // エンベロープにおいて，エフェクトエコーが終わっている or
+    // リリース状態のとき
+    if (activeSamples < chunkSize) {
+      clearCurrentNote();
+      clear();
+      break;
     }
+  }
 
-    // 周期切り捨て
-    currentAngle = fmod(currentAngle, TWO_PI);
-    vibratoAngle = fmod(vibratoAngle, TWO_PI);
+  // サンプル処理中のEchoBuffer::init()も記録する
+  traceEchoBufferInits();
+}
 
-    // エンベロープパラメータを更新して時間分進める
-    ampEnv.cycle((float)getSampleRate());
-    vibratoEnv.cycle((float)getSampleRate());
-    portaEnv.cycle((float)getSampleRate());
-    colorEnv.cycle((float)getSampleRate());
-  }
+void SimpleVoice::setCurrentPlaybackSampleRate(double newRate) {
+  SynthesiserVoice::setCurrentPlaybackSampleRate(newRate);
+  eb.setSampleRate((std::int32_t)newRate);
+  vibratoAmount.reset(newRate, PARAMETER_RAMP_SECONDS);
+  traceEchoBufferInits();
+  // 次のレンダリングでエンベロープなどを新しいサンプルレートで設定し直す
+  _snapshotSerial = _parameterSnapshot->serial - 1u;
 }
 
 void SimpleVoice::clear() {
   currentAngle = 0.0f;
   vibratoAngle = 0.0f;
   angleDelta = 0.0f;
-  // portaAngleDelta = 0.0f; // portaはリセットしない
   level = 0.0f;
   pitchBend = 0.0f;
   pitchSweep = 0.0f;
+  macroPitchFactor = 1.0f;
   patternWaveClear();
   waveForms.init();
 }
@@ -261,55 +350,46 @@ void SimpleVoice::clear() {
 void SimpleVoice::patternWaveClear() {
   patternCounter = 0;
   patternIndex = 0;
-  patternStepNum = 0.0f;
 }
 
 float SimpleVoice::calcModulationFactor(float angle) {
   float factor = waveForms.sine(angle);
 
   // factorの値が0.5を中心とした0.0～1.0の値となるように調整する。
-  factor *= _vibratoParamsPtr->VibratoAmount->get();
+  factor *= vibratoAmount.getCurrentValue();
   return factor;
 }
 
-float SimpleVoice::angle2wave(float angle, float angleDelta, const juce::String& waveName) {
-  auto value = 0.0f;
-  if (waveName == "NES_Square50%") {
-    value = waveForms.nesSquare(angle);
-  } else if (waveName == "NES_Square25%") {
-    value = waveForms.nesSquare25(angle);
-  } else if (waveName == "NES_Square12.5%") {
-    value = waveForms.nesSquare125(angle);
-  } else if (waveName == "NES_Triangle") {
-    value = waveForms.nesTriangle(angle);
-  } else if (waveName == "NES_LongNoise") {
-    value = waveForms.longNoise(angleDelta);
-  } else if (waveName == "NES_ShortNoise") {
-    value = waveForms.shortNoise(angleDelta);
-  } else if (waveName == "Pure_Sine") {
-    value = waveForms.sine(angle);
-  } else if (waveName == "Rough_Sine") {
-    value = waveForms.roughSine(angle);
-  } else if (waveName == "Pure_Saw") {
-    value = waveForms.saw(angle);
-  } else if (waveName == "Rough_Saw") {
-    value = waveForms.roughSaw(angle);
-  } else if (waveName == "Pure_Triangle") {
-    value = waveForms.triangle(angle);
-  } else if (waveName == "Pure_Square50%") {
-    value = waveForms.square(angle);
-  } else if (waveName == "Pure_Square25%") {
-    value = waveForms.square25(angle);
-  } else if (waveName == "Pure_Square12.5%") {
-    value = waveForms.square125(angle);
-  } else if (waveName == "Pure_Noise") {
-    value = waveForms.noise(angleDelta);
-  } else if (waveName == "Rough_Noise") {
-    value = waveForms.lobitNoise(angleDelta);
-  } else if (waveName == "Waveform Memory") {
-    value = waveForms.waveformMemory(angle, _waveformMemoryParamsPtr);
+void SimpleVoice::traceEchoBufferInits() {
+  const auto numInits = eb.getNumInits();
+  if (numInits != _lastEchoBufferInits) {
+    SANA_TRACE_INSTANT(_traceRecorder, "EchoBuffer::init", TraceRecorder::VOICE_TRACK_OFFSET + _voiceIndex,
+                       (float)(numInits - _lastEchoBufferInits), 0.0f);
+    _lastEchoBufferInits = numInits;
   }
-  return value;
+}
+
+void SimpleVoice::applyParameterSnapshot() {
+  const auto& params = *_parameterSnapshot;
+  if (params.serial == _snapshotSerial) {
+    return;
+  }
+  _snapshotSerial = params.serial;
+
+  _waveKernel = params.waveKernel;
+  updateEnvParams(ampEnv, vibratoEnv, filterEnv, params.frameRate);
+  colorEnv.beginBlock(params.frameRate);
+  vibratoAmount.setTargetValue(params.vibratoAmount);
+  macroClock.setRate(getSampleRate(), params.frameRate);
+  // マクロはフレーム単位で進めるため, 時間はフレーム数に直しておく
+  patternStepNum = params.patternStepTime * params.frameRate;
+  eb.updateParam(params.echoDuration, params.echoRepeat);
+  traceEchoBufferInits();
+}
+
+void SimpleVoice::setWaveType(std::int32_t waveType) {
+  *(_chipOscParamsPtr->OscWaveType) = waveType;
+  _waveKernel = getWaveTypeInfo((WAVE_TYPE)waveType).kernel;
 }
 
 bool SimpleVoice::canStartNote() {
@@ -320,13 +400,21 @@ bool SimpleVoice::canStartNote() {
   return false;
 }
 
-void SimpleVoice::updateEnvParams(AmpEnvelope& ampEnv, AmpEnvelope& vibratoEnv, AmpEnvelope& portaEnv) {
-  ampEnv.setParameters(_chipOscParamsPtr->Attack->get(),
-                      _chipOscParamsPtr->Decay->get(),
-                      _chipOscParamsPtr->Sustain->get(),
-                      _chipOscParamsPtr->Release->get(),
-                      _midiEchoParamsPtr->EchoDuration->get() *
-                          _midiEchoParamsPtr->EchoRepeat->get());
-  vibratoEnv.setParameters(_vibratoParamsPtr->VibratoAttackTime->get(), 0.1f, 1.0f, 0.1f, 0.0f);
-  portaEnv.setParameters(_voicingParamsPtr->StepTime->get(), 0.0f, 1.0f, 0.0f, 0.0f);
+bool SimpleVoice::isLegatoEnabled() {
+  return _voicingParamsPtr->Legato->get() &&
+         toChipType<VOICING_TYPE>(_voicingParamsPtr->VoicingSwitch) != VOICING_TYPE::POLY;
+}
+
+void SimpleVoice::updateEnvParams(AmpEnvelope& ampEnv, AmpEnvelope& vibratoEnv, AmpEnvelope& filterEnv,
+                                  float frameRate) {
+  // ビブラートのエンベロープはマクロのフレームごとに進める
+  const auto sampleRate = (float)getSampleRate();
+  ampEnv.setSampleRate(sampleRate);
+  vibratoEnv.setSampleRate(frameRate);
+  filterEnv.setSampleRate(sampleRate);
+  const auto& params = *_parameterSnapshot;
+  ampEnv.setParameters(params.attack, params.decay, params.sustain, params.release,
+                       params.echoDuration * params.echoRepeat);
+  vibratoEnv.setParameters(params.vibratoAttackTime, 0.1f, 1.0f, 0.1f, 0.0f);
+  filterEnv.setParameters(params.filterAttack, params.filterDecay, params.filterSustain, params.filterRelease, 0.0f);
 }
\ No newline at end of file
@@ -3,8 +3,13 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "AmpEnvelope.h"
 #include "ColorEnvelope.h"
+#include "GlideUnit.h"
+#include "MacroClock.h"
 #include "MIDIEcho.h"
 #include "SimpleSound.h"
+#include "TraceRecorder.h"
+#include "VoiceFilter.h"
+#include "VoiceParameterSnapshot.h"
 #include "Waveforms.h"
 
 class SimpleVoice : public SynthesiserVoice {
@@ -15,7 +20,12 @@ class SimpleVoice : public SynthesiserVoice {
               OptionsParameters* optionsParams,
               MidiEchoParameters* midiEchoParams,
               WaveformMemoryParameters* waveformMemoryParams,
-              WavePatternParameters* wavePatternParams);
+              WavePatternParameters* wavePatternParams,
+              VoiceFilterParameters* voiceFilterParams,
+              VoiceFilterBank* voiceFilterBank,
+              const ColorTableBank* colorTableBank,
+              const VoiceParameterSnapshot* parameterSnapshot,
+              std::int32_t voiceIndex);
 
   virtual ~SimpleVoice() = default;
 
@@ -29,28 +39,58 @@ class SimpleVoice : public SynthesiserVoice {
                                int newControllerValue) override;
   virtual void renderNextBlock(AudioBuffer<float>& outputBuffer,
                                int startSample, int numSamples) override;
+  virtual void setCurrentPlaybackSampleRate(double newRate) override;
+
+  // エコーのバッファを, 指定した長さと回数が入る大きさで確保し直す. prepareToPlayから呼ぶ
+  void prepareEchoBuffer(float sec, std::int32_t count) { eb.prepare(sec, count); }
+  // 足りなければエコーのバッファを大きくする. オーディオスレッド以外から再生中に呼ぶ
+  void reserveEchoBuffer(float sec, std::int32_t count) { eb.reserve(sec, count); }
+
+  // トレースの記録先. nullptrなら記録しない
+  void setTraceRecorder(TraceRecorder* recorder) { _traceRecorder = recorder; }
 
  private:
   void clear();
   void patternWaveClear();
   float calcModulationFactor(float angle);
-  float angle2wave(float angle, float angleDelta, const juce::String& waveName);
   bool canStartNote();
-  void updateEnvParams(AmpEnvelope& ampEnv, AmpEnvelope& vibratoEnv, AmpEnvelope& portaEnv);
+  // MONO / PORTAMENTOでLegatoが有効
+  bool isLegatoEnabled();
+  void traceEchoBufferInits();
+  // スナップショットが更新されていれば, エンベロープなどの設定をやり直す
+  void applyParameterSnapshot();
+  void setWaveType(std::int32_t waveType);
+  void updateEnvParams(AmpEnvelope& ampEnv, AmpEnvelope& vibratoEnv, AmpEnvelope& filterEnv, float frameRate);
+
+  // 1回のrenderNextBlockで処理するサンプル数の上限. エンベロープはこの長さずつまとめて計算する
+  static constexpr std::int32_t ENVELOPE_BUFFER_SIZE = SUB_BLOCK_SIZE * UP_SAMPLING_FACTOR;
 
-  float currentAngle, vibratoAngle, angleDelta, portaAngleDelta = 0.0f;
+  float currentAngle, vibratoAngle, angleDelta;
   float level;
   float pitchBend, pitchSweep;
+  // ビブラート, スイープ, 音色エンベロープによるピッチの倍率. フレームごとに更新する
+  float macroPitchFactor = 1.0f;
+  // ビブラートの深さ. 変わったときはエンベロープのチャンクごとに新しい値へ移動する
+  SmoothedValue<float> vibratoAmount;
   std::vector<float> echoSamples;
 
   EchoBuffer eb;
 
   // Waveform用のパラメータ
   Waveforms waveForms;
-  //各種エンベロープ， アンプ， ビブラート， ポルタメント用
-  AmpEnvelope ampEnv, vibratoEnv, portaEnv;
+  //各種エンベロープ， アンプ， ビブラート， フィルタ用
+  AmpEnvelope ampEnv, vibratoEnv, filterEnv;
+  // renderBlockで計算したアンプ, フィルタのエンベロープの値
+  float ampValues[ENVELOPE_BUFFER_SIZE];
+  float filterValues[ENVELOPE_BUFFER_SIZE];
+  // ポルタメント
+  GlideUnit glide;
+  // 押鍵中にボイススチールされた. 直後のstartNoteはレガート(前の音からの続き)として扱う
+  bool _isStolenWhileHolding = false;
   // 音色エンベロープ
   ColorEnvelope colorEnv;
+  // マクロを進めるフレームのクロック
+  MacroClock macroClock;
 
   // パラメータを管理するオブジェクトのポインタ変数。
   ChipOscillatorParameters* _chipOscParamsPtr;
@@ -61,6 +101,20 @@ class SimpleVoice : public SynthesiserVoice {
   MidiEchoParameters* _midiEchoParamsPtr;
   WaveformMemoryParameters* _waveformMemoryParamsPtr;
   WavePatternParameters* _wavePatternParams;
+  VoiceFilterParameters* _voiceFilterParamsPtr;
+
+  // プロセッサがブロックごとに読み込んだパラメータ. serialが変わったときだけ設定し直す
+  const VoiceParameterSnapshot* _parameterSnapshot;
+  std::uint32_t _snapshotSerial = 0;
+  // 鳴らす波形. 波形パターンはブロックの途中でも切り替える
+  WaveKernel _waveKernel;
+
+  // ボイスフィルタ. 自身のレーン番号にサンプルを書き込む
+  VoiceFilterBank* _voiceFilterBank;
+  std::int32_t _voiceIndex;
+
+  TraceRecorder* _traceRecorder = nullptr;
+  int _lastEchoBufferInits = 0;
 
   int patternCounter = 0;
   int patternIndex = 0;
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+/*
+--------------------------------------------------------------------------------
+SoftClipper
+tanhのパデ近似 f(x) = x(27 + x^2) / (27 + 9x^2) を使ったソフトクリッパー.
+|x| >= 3 で f(x) = ±1 に張り付き, その点で傾きも0になるので折れ目ができない.
+1次の逆導関数によるアンチエイリアス(ADAA)を行い,
+  y[n] = (F(x[n]) - F(x[n-1])) / (x[n] - x[n-1])
+を出力する. 原関数 F は |x| < 3 で x^2 / 18 + (4/3) ln(x^2 + 3).
+|x| <= 3 の範囲では差分商を
+  (x + x1) / 18 + (8/3) (x + x1) / D * atanh(s) / s,  D = x^2 + x1^2 + 6,  s = (x^2 - x1^2) / D
+と変形して計算する. |s| <= 0.6 なので atanh(s) / s は s^2 の多項式で近似でき,
+F同士の引き算も入力が近いときの割り算もないため, 分岐なしにfloatのまま計算できる.
+範囲外(ドライブで振り切れたとき)だけdoubleの原関数の差を使う.
+ドライブを深くしてもオーバーサンプリングなしでエイリアスを抑えられる.
+出力は入力に対して0.5サンプル遅れる.
+https://dafx2016.vutbr.cz/dafx16/papers/DAFx-16_paper_41-PN.pdf
+--------------------------------------------------------------------------------
+*/
+class SoftClipper {
+ public:
+  // 1度に処理するサンプル数. 原関数の計算とADAAの計算をこの単位でまとめて行う
+  static constexpr std::int32_t CHUNK_SIZE = 64;
+
+  SoftClipper(){};
+
+  void prepare(std::int32_t numChannels) {
+    _states.resize((size_t)jmax(numChannels, 1));
+    reset();
+  }
+
+  void reset() {
+    for (auto& state : _states) {
+      state.x1 = 0.0f;
+    }
+  }
+
+  void process(const dsp::ProcessContextReplacing<float>& context) {
+    auto& block = context.getOutputBlock();
+    const auto numChannels = jmin((std::int32_t)block.getNumChannels(), (std::int32_t)_states.size());
+
+    for (auto channel = 0; channel < numChannels; ++channel) {
+      processSamples(channel, block.getChannelPointer((size_t)channel), (std::int32_t)block.getNumSamples());
+    }
+  }
+
+  void processSamples(std::int32_t channel, float* samples, std::int32_t numSamples) {
+    jassert(channel < (std::int32_t)_states.size());
+    auto& state = _states[(size_t)channel];
+
+    for (auto start = 0; start < numSamples; start += CHUNK_SIZE) {
+      const auto n = jmin(CHUNK_SIZE, numSamples - start);
+      processChunk(state, samples + start, n);
+    }
+  }
+
+  // クリップ関数本体(パデ近似tanh)
+  static inline float clip(float x) {
+    const auto xc = jlimit(-3.0f, 3.0f, x);
+    const auto x2 = xc * xc;
+    return xc * (27.0f + x2) / (27.0f + 9.0f * x2);
+  }
+
+  // clipの原関数. 振り切れた範囲で差を取るためdoubleで計算する
+  static inline double antiderivative(float x) {
+    const auto ax = (double)std::abs(x);
+    const auto xc = jmin(ax, 3.0);
+    const auto x2 = xc * xc;
+    return x2 / 18.0 + (4.0 / 3.0) * std::log(x2 + 3.0) + jmax(ax - 3.0, 0.0);
+  }
+
+  // 1サンプル分のADAAの出力. x1は1つ前の入力
+  static inline float differenceQuotient(float x, float x1) {
+    if (std::abs(x) <= 3.0f && std::abs(x1) <= 3.0f) {
+      return kneeDifferenceQuotient(x, x1);
+    }
+    return outerDifferenceQuotient(x, x1);
+  }
+
+  // |x|, |x1| <= 3 の差分商. 分岐がなく, 入力が近くても桁落ちしない
+  static inline float kneeDifferenceQuotient(float x, float x1) {
+    const auto sum = x + x1;
+    const auto invD = 1.0f / (x * x + x1 * x1 + 6.0f);
+    const auto s = (x - x1) * sum * invD;
+    return sum * (1.0f / 18.0f) + (8.0f / 3.0f) * sum * invD * atanhRatio(s * s);
+  }
+
+  // どちらかが振り切れた範囲の差分商. 原関数の差をdoubleで求める
+  static inline float outerDifferenceQuotient(float x, float x1) {
+    // 同じ側に振り切れたままなら原関数の差は x - x1 になり, 差分商はちょうど±1
+    if (x >= 3.0f && x1 >= 3.0f) {
+      return 1.0f;
+    }
+    if (x <= -3.0f && x1 <= -3.0f) {
+      return -1.0f;
+    }
+    const auto dx = (double)x - (double)x1;
+    if (std::abs(dx) < MIN_DELTA) {
+      return clip(0.5f * (x + x1));
+    }
+    return (float)((antiderivative(x) - antiderivative(x1)) / dx);
+  }
+
+ private:
+  // 振り切れた範囲で, 前後のサンプル差がこれより小さいときは差分商の代わりに中点の値を使う
+  static constexpr double MIN_DELTA = 1.0e-5;
+
+  struct ChannelState {
+    float x1 = 0.0f;
+  };
+
+  // atanh(s) / s を t = s^2 (0 <= t <= 0.36) の6次多項式で近似する. 誤差は4e-8以下
+  static inline float atanhRatio(float t) {
+    return 1.0000000232f +
+           t * (0.3333270425f +
+                t * (0.2002748676f +
+                     t * (0.1384286957f + t * (0.1442409772f + t * (-0.0305379186f + t * 0.2734828438f)))));
+  }
+
+  void processChunk(ChannelState& state, float* samples, std::int32_t numSamples) {
+    float x1[CHUNK_SIZE];
+
+    // 1つ前の入力を並べておく. 以降のループはサンプル間の依存がない
+    x1[0] = state.x1;
+    for (auto i = 1; i < numSamples; ++i) {
+      x1[i] = samples[i - 1];
+    }
+    const auto peak = jmax(std::abs(state.x1), FloatVectorOperations::findMaximum(samples, numSamples),
+                           -FloatVectorOperations::findMinimum(samples, numSamples));
+    state.x1 = samples[numSamples - 1];
+
+    // 振り切れていない範囲の式で全サンプルを分岐なしに求める.
+    // 範囲外の入力でも |s| < 1 なので有限の値になり, 下で求め直す
+    float y[CHUNK_SIZE];
+    for (auto i = 0; i < numSamples; ++i) {
+      y[i] = kneeDifferenceQuotient(samples[i], x1[i]);
+    }
+
+    // 振り切れたサンプルがあるチャンクだけ, その前後を原関数の差で求め直す
+    if (peak > 3.0f) {
+      for (auto i = 0; i < numSamples; ++i) {
+        if (std::abs(samples[i]) > 3.0f || std::abs(x1[i]) > 3.0f) {
+          y[i] = outerDifferenceQuotient(samples[i], x1[i]);
+        }
+      }
+    }
+    FloatVectorOperations::copy(samples, y, numSamples);
+  }
+
+  std::vector<ChannelState> _states;
+};
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+// processBlockの区間ごとの処理時間を計測する. 既定ではデバッグビルドのみ有効.
+// 0にすると計測用のマクロは空になり, プロセッサのメンバとエディタのProfilerボタンも組み込まれない
+#ifndef SANA_ENABLE_PROFILER
+#define SANA_ENABLE_PROFILER JUCE_DEBUG
+#endif
+
+#if SANA_ENABLE_PROFILER
+#define SANA_PROFILE_STAGE(profiler, stage) \
+  StageProfiler::ScopedStage JUCE_JOIN_MACRO(stageScope_, __LINE__)(profiler, stage)
+#define SANA_PROFILE_BEGIN_BLOCK(profiler) (profiler).beginBlock()
+#define SANA_PROFILE_END_BLOCK(profiler, numSamples, sampleRate) (profiler).endBlock(numSamples, sampleRate)
+#else
+#define SANA_PROFILE_STAGE(profiler, stage)
+#define SANA_PROFILE_BEGIN_BLOCK(profiler)
+#define SANA_PROFILE_END_BLOCK(profiler, numSamples, sampleRate)
+#endif
+
+/*
+--------------------------------------------------------------------------------
+StageProfiler
+オーディオスレッドで区間ごとの経過時間(高分解能ティック)を積算し,
+ブロックの終わりに1件のレコードとしてロックなしのリングバッファへ書き込む.
+GUIスレッドはcollectでレコードを回収し, 直近のレコードから区間ごとの
+最小/平均/99パーセンタイル/最大と, ブロックの締め切りに対する負荷率を計算する.
+--------------------------------------------------------------------------------
+*/
+class StageProfiler {
+ public:
+  enum class Stage {
+    MIDI = 0,
+    VOICES,
+    VOICE_FILTER,
+    DECIMATION,
+    EFFECTS,  // ドライブ, フィルタ, クリッパー(1回の走査にまとめて処理している)
+    SCOPE_TAP,  // EFFECTSの走査の中で呼ばれる. endBlockでEFFECTSから差し引く
+    TOTAL,
+    NUM_STAGES,
+  };
+
+  static constexpr std::int32_t NUM_STAGES = (std::int32_t)Stage::NUM_STAGES;
+  static constexpr std::int32_t RING_SIZE = 1024;
+  // 統計に使う直近のレコード数
+  static constexpr std::int32_t HISTORY_SIZE = 512;
+
+  struct StageStats {
+    double minMicroseconds = 0.0;
+    double avgMicroseconds = 0.0;
+    double p99Microseconds = 0.0;
+    double maxMicroseconds = 0.0;
+  };
+
+  struct Stats {
+    std::array<StageStats, NUM_STAGES> stages;
+    // ブロックの長さに対するTOTALの割合(%)
+    double avgLoadPercent = 0.0;
+    double maxLoadPercent = 0.0;
+    std::int32_t numBlocks = 0;
+  };
+
+  class ScopedStage {
+   public:
+    ScopedStage(StageProfiler& profiler, Stage stage)
+        : _profiler(profiler), _stage(stage), _start(Time::getHighResolutionTicks()) {}
+    ~ScopedStage() { _profiler.add(_stage, Time::getHighResolutionTicks() - _start); }
+
+   private:
+    StageProfiler& _profiler;
+    Stage _stage;
+    std::int64_t _start;
+  };
+
+  StageProfiler() { _history.reserve((size_t)HISTORY_SIZE); }
+
+  static const char* getStageName(Stage stage) {
+    switch (stage) {
+      case Stage::MIDI:
+        return "MIDI";
+      case Stage::VOICES:
+        return "Voices";
+      case Stage::VOICE_FILTER:
+        return "VoiceFilter";
+      case Stage::DECIMATION:
+        return "Decimation";
+      case Stage::EFFECTS:
+        return "Drive/Filter/Clip";
+      case Stage::SCOPE_TAP:
+        return "ScopeTap";
+      case Stage::TOTAL:
+        return "Total";
+      default:
+        return "";
+    }
+  }
+
+  // 以下はオーディオスレッドから呼ぶ
+  void beginBlock() { _current.ticks.fill(0); }
+
+  void add(Stage stage, std::int64_t ticks) { _current.ticks[(size_t)stage] += ticks; }
+
+  void endBlock(std::int32_t numSamples, double sampleRate) {
+    _current.ticks[(size_t)Stage::EFFECTS] -= _current.ticks[(size_t)Stage::SCOPE_TAP];
+    _current.numSamples = numSamples;
+    _current.sampleRate = sampleRate;
+
+    int start1, size1, start2, size2;
+    _fifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 > 0) {
+      _ring[(size_t)start1] = _current;
+    }
+    // 一杯のときはGUIが読みに来るまで捨てる
+    _fifo.finishedWrite(size1);
+  }
+
+  // 以下はGUIスレッドから呼ぶ. 溜まったレコードを回収して統計を計算し直す
+  const Stats& collect() {
+    int start1, size1, start2, size2;
+    _fifo.prepareToRead(_fifo.getNumReady(), start1, size1, start2, size2);
+    for (auto i = start1; i < start1 + size1; ++i) {
+      pushHistory(_ring[(size_t)i]);
+    }
+    for (auto i = start2; i < start2 + size2; ++i) {
+      pushHistory(_ring[(size_t)i]);
+    }
+    _fifo.finishedRead(size1 + size2);
+
+    if (size1 + size2 > 0) {
+      updateStats();
+    }
+    return _stats;
+  }
+
+  const Stats& getStats() const { return _stats; }
+
+ private:
+  struct Record {
+    std::array<std::int64_t, NUM_STAGES> ticks{};
+    std::int32_t numSamples = 0;
+    double sampleRate = 0.0;
+  };
+
+  void pushHistory(const Record& record) {
+    if ((std::int32_t)_history.size() < HISTORY_SIZE) {
+      _history.push_back(record);
+    } else {
+      _history[(size_t)_historyIndex] = record;
+    }
+    _historyIndex = (_historyIndex + 1) % HISTORY_SIZE;
+  }
+
+  void updateStats() {
+    const auto ticksToMicroseconds = 1.0e6 / (double)Time::getHighResolutionTicksPerSecond();
+    const auto numBlocks = _history.size();
+    std::vector<double> values(numBlocks);
+
+    for (auto stage = 0; stage < NUM_STAGES; ++stage) {
+      auto sum = 0.0;
+      for (size_t i = 0; i < numBlocks; ++i) {
+        values[i] = (double)_history[i].ticks[(size_t)stage] * ticksToMicroseconds;
+        sum += values[i];
+      }
+      std::sort(values.begin(), values.end());
+
+      auto& stats = _stats.stages[(size_t)stage];
+      stats.minMicroseconds = values.front();
+      stats.maxMicroseconds = values.back();
+      stats.avgMicroseconds = sum / (double)numBlocks;
+      stats.p99Microseconds = values[jmin(numBlocks - 1, (size_t)((double)numBlocks * 0.99))];
+    }
+
+    auto loadSum = 0.0, loadMax = 0.0;
+    for (const auto& record : _history) {
+      if (record.numSamples <= 0 || record.sampleRate <= 0.0) {
+        continue;
+      }
+      const auto deadlineMicroseconds = 1.0e6 * record.numSamples / record.sampleRate;
+      const auto load = 100.0 * (double)record.ticks[(size_t)Stage::TOTAL] * ticksToMicroseconds / deadlineMicroseconds;
+      loadSum += load;
+      loadMax = jmax(loadMax, load);
+    }
+    _stats.avgLoadPercent = loadSum / (double)numBlocks;
+    _stats.maxLoadPercent = loadMax;
+    _stats.numBlocks = (std::int32_t)numBlocks;
+  }
+
+  // オーディオスレッド側
+  Record _current;
+  std::array<Record, RING_SIZE> _ring;
+  AbstractFifo _fifo{RING_SIZE};
+
+  // GUIスレッド側
+  std::vector<Record> _history;
+  std::int32_t _historyIndex = 0;
+  Stats _stats;
+};
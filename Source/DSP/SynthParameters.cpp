@@ -119,43 +119,74 @@ void VibratoParameters::loadParameters(XmlElement& xml) {
 //-----------------------------------------------------------------------------------------
 
 VoicingParameters::VoicingParameters(AudioParameterChoice* voicingSwitch,
-                                     AudioParameterFloat* stepTime)
-    : VoicingSwitch(voicingSwitch), StepTime(stepTime) {}
+                                     AudioParameterFloat* stepTime,
+                                     AudioParameterChoice* glideMode,
+                                     AudioParameterBool* legato,
+                                     AudioParameterChoice* notePriority)
+    : VoicingSwitch(voicingSwitch),
+      StepTime(stepTime),
+      GlideMode(glideMode),
+      Legato(legato),
+      NotePriority(notePriority) {}
 
 void VoicingParameters::addAllParameters(AudioProcessor& processor) {
   processor.addParameter(VoicingSwitch);
   processor.addParameter(StepTime);
+  // GlideMode, Legato, NotePriorityは既存のパラメータの番号を変えないよう, PluginProcessorで最後に登録する
 }
 
 void VoicingParameters::saveParameters(XmlElement& xml) {
   xml.setAttribute(VoicingSwitch->paramID, VoicingSwitch->getIndex());
   xml.setAttribute(StepTime->paramID, StepTime->get());
+  xml.setAttribute(GlideMode->paramID, GlideMode->getIndex());
+  xml.setAttribute(Legato->paramID, Legato->get());
+  xml.setAttribute(NotePriority->paramID, NotePriority->getIndex());
 }
 
 void VoicingParameters::loadParameters(XmlElement& xml) {
   *VoicingSwitch = xml.getIntAttribute(VoicingSwitch->paramID, 0);
   *StepTime = (float)xml.getDoubleAttribute(StepTime->paramID, 1.0);
+  *GlideMode = xml.getIntAttribute(GlideMode->paramID, 0);
+  *Legato = xml.getBoolAttribute(Legato->paramID, false);
+  *NotePriority = xml.getIntAttribute(NotePriority->paramID, 0);
 }
 
 //-----------------------------------------------------------------------------------------
 
 OptionsParameters::OptionsParameters(AudioParameterInt* pitchBendRange,
-                                     AudioParameterInt* pitchStandard)
-    : PitchBendRange(pitchBendRange), PitchStandard(pitchStandard) {}
+                                     AudioParameterInt* pitchStandard,
+                                     AudioParameterChoice* macroClock)
+    : PitchBendRange(pitchBendRange), PitchStandard(pitchStandard), MacroClock(macroClock) {}
+
+float OptionsParameters::getMacroFrameRate(float sampleRate) const {
+  const auto type = toChipType<MACRO_CLOCK_TYPE>(MacroClock);
+  const auto frameRate = MACRO_CLOCK_TYPE_INFOS[(std::int32_t)type].frameRate;
+  if (type == MACRO_CLOCK_TYPE::TEMPO) {
+    return jmax(1.0f, currentBPM / 60.0f * frameRate);
+  }
+  if (type == MACRO_CLOCK_TYPE::SAMPLE) {
+    return sampleRate;
+  }
+  return frameRate;
+}
 
 void OptionsParameters::addAllParameters(AudioProcessor& processor) {
   processor.addParameter(PitchBendRange);
   processor.addParameter(PitchStandard);
+  // MacroClockは既存のパラメータの番号を変えないよう, PluginProcessorで最後に登録する
 }
 
 void OptionsParameters::saveParameters(XmlElement& xml) {
   xml.setAttribute(PitchBendRange->paramID, (double)PitchBendRange->get());
   xml.setAttribute(PitchStandard->paramID, (double)PitchStandard->get());
+  xml.setAttribute(MacroClock->paramID, MacroClock->getIndex());
 }
 
 void OptionsParameters::loadParameters(XmlElement& xml) {
   *PitchBendRange = xml.getIntAttribute(PitchBendRange->paramID, 2);
   *PitchStandard = xml.getIntAttribute(PitchStandard->paramID, 440);
+  // MACRO_CLOCKがない(追加前に保存した)ステートは, 以前と同じ音になるようサンプルごとに進める
+  *MacroClock = xml.getIntAttribute(MacroClock->paramID, (int)MACRO_CLOCK_TYPE::SAMPLE);
 }
 
 //-----------------------------------------------------------------------------------------
@@ -252,6 +283,68 @@ void FilterParameters::loadParameters(XmlElement& xml) {
 
 //-----------------------------------------------------------------------------------------
 
+VoiceFilterParameters::VoiceFilterParameters(AudioParameterBool* filterEnable,
+                                             AudioParameterChoice* filterType,
+                                             AudioParameterFloat* cutoff,
+                                             AudioParameterFloat* resonance,
+                                             AudioParameterFloat* keyTrack,
+                                             AudioParameterFloat* envAmount,
+                                             AudioParameterFloat* attack,
+                                             AudioParameterFloat* decay,
+                                             AudioParameterFloat* sustain,
+                                             AudioParameterFloat* release)
+    : FilterEnable(filterEnable),
+      FilterType(filterType),
+      Cutoff(cutoff),
+      Resonance(resonance),
+      KeyTrack(keyTrack),
+      EnvAmount(envAmount),
+      Attack(attack),
+      Decay(decay),
+      Sustain(sustain),
+      Release(release) {}
+
+void VoiceFilterParameters::addAllParameters(AudioProcessor& processor) {
+  processor.addParameter(FilterEnable);
+  processor.addParameter(FilterType);
+  processor.addParameter(Cutoff);
+  processor.addParameter(Resonance);
+  processor.addParameter(KeyTrack);
+  processor.addParameter(EnvAmount);
+  processor.addParameter(Attack);
+  processor.addParameter(Decay);
+  processor.addParameter(Sustain);
+  processor.addParameter(Release);
+}
+
+void VoiceFilterParameters::saveParameters(XmlElement& xml) {
+  xml.setAttribute(FilterEnable->paramID, FilterEnable->get());
+  xml.setAttribute(FilterType->paramID, FilterType->getIndex());
+  xml.setAttribute(Cutoff->paramID, (double)Cutoff->get());
+  xml.setAttribute(Resonance->paramID, (double)Resonance->get());
+  xml.setAttribute(KeyTrack->paramID, (double)KeyTrack->get());
+  xml.setAttribute(EnvAmount->paramID, (double)EnvAmount->get());
+  xml.setAttribute(Attack->paramID, (double)Attack->get());
+  xml.setAttribute(Decay->paramID, (double)Decay->get());
+  xml.setAttribute(Sustain->paramID, (double)Sustain->get());
+  xml.setAttribute(Release->paramID, (double)Release->get());
+}
+
+void VoiceFilterParameters::loadParameters(XmlElement& xml) {
+  *FilterEnable = xml.getBoolAttribute(FilterEnable->paramID, false);
+  *FilterType = xml.getIntAttribute(FilterType->paramID, 0);
+  *Cutoff = (float)xml.getDoubleAttribute(Cutoff->paramID, 20000.0);
+  *Resonance = (float)xml.getDoubleAttribute(Resonance->paramID, 0.707);
+  *KeyTrack = (float)xml.getDoubleAttribute(KeyTrack->paramID, 0.0);
+  *EnvAmount = (float)xml.getDoubleAttribute(EnvAmount->paramID, 0.0);
+  *Attack = (float)xml.getDoubleAttribute(Attack->paramID, 0.0);
+  *Decay = (float)xml.getDoubleAttribute(Decay->paramID, 0.0);
+  *Sustain = (float)xml.getDoubleAttribute(Sustain->paramID, 1.0);
+  *Release = (float)xml.getDoubleAttribute(Release->paramID, 0.0);
+}
+
+//-----------------------------------------------------------------------------------------
+
 PresetsParameters::PresetsParameters() {
   ProgramIndex = new AudioParameterInt("PROGRAM_INDEX", "Program-Index", 0, NUM_OF_PRESETS, 0);
 }
@@ -270,6 +363,47 @@ void PresetsParameters::loadParameters(XmlElement& xml) {
 
 //-----------------------------------------------------------------------------------------
 
+ColorSequenceParameters::ColorSequenceParameters() {
+  for (auto i = 0; i < COLOR_SEQUENCE_LENGTH; ++i) {
+    std::string name = "ColorSequence" + std::to_string(i);
+    Steps[i] = new AudioParameterInt(name, name, -24, 24, 0);
+  }
+
+  Length = new AudioParameterInt("COLOR_SEQUENCE_LENGTH", "Color-Sequence-Length", 1, COLOR_SEQUENCE_LENGTH, 4);
+  LoopEnabled = new AudioParameterBool("COLOR_SEQUENCE_LOOP_ENABLE", "Color-Sequence-Loop-Enable", true);
+  LoopStart = new AudioParameterInt("COLOR_SEQUENCE_LOOP_START", "Color-Sequence-Loop-Start", 0,
+                                    COLOR_SEQUENCE_LENGTH - 1, 0);
+}
+
+void ColorSequenceParameters::addAllParameters(AudioProcessor& processor) {
+  for (auto i = 0; i < COLOR_SEQUENCE_LENGTH; ++i) {
+    processor.addParameter(Steps[i]);
+  }
+  processor.addParameter(Length);
+  processor.addParameter(LoopEnabled);
+  processor.addParameter(LoopStart);
+}
+
+void ColorSequenceParameters::saveParameters(XmlElement& xml) {
+  for (auto i = 0; i < COLOR_SEQUENCE_LENGTH; ++i) {
+    xml.setAttribute(Steps[i]->paramID, (std::int32_t)Steps[i]->get());
+  }
+  xml.setAttribute(Length->paramID, (std::int32_t)Length->get());
+  xml.setAttribute(LoopEnabled->paramID, (double)LoopEnabled->get());
+  xml.setAttribute(LoopStart->paramID, (std::int32_t)LoopStart->get());
+}
+
+void ColorSequenceParameters::loadParameters(XmlElement& xml) {
+  for (auto i = 0; i < COLOR_SEQUENCE_LENGTH; ++i) {
+    *Steps[i] = xml.getIntAttribute(Steps[i]->paramID, 0);
+  }
+  *Length = xml.getIntAttribute(Length->paramID, 4);
+  *LoopEnabled = xml.getBoolAttribute(LoopEnabled->paramID, true);
+  *LoopStart = xml.getIntAttribute(LoopStart->paramID, 0);
+}
+
+//-----------------------------------------------------------------------------------------
+
 WavePatternParameters::WavePatternParameters() {
   for (auto i = 0; i < WAVEPATTERN_LENGTH; ++i) {
     std::string name = "WavePattern" + std::to_string(i);
@@ -278,7 +412,7 @@ WavePatternParameters::WavePatternParameters() {
 
   for (auto i = 0; i < WAVEPATTERN_TYPES; ++i) {
     std::string name = "WavePatternType" + std::to_string(i);
-    WaveTypes[i] = new AudioParameterChoice(name, name, OSC_WAVE_TYPES, 0);
+    WaveTypes[i] = new AudioParameterChoice(name, name, getChoiceNames(WAVE_TYPE_INFOS), 0);
   }
 
   PatternEnabled = new AudioParameterBool("PATTERN_ENABLE", "Pattern-Enable", false);
@@ -1,35 +1,20 @@
 #pragma once
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "ChipTypes.h"
 
 namespace {
 const std::int32_t WAVESAMPLE_LENGTH = 32;
 const std::int32_t WAVEPATTERN_LENGTH = 16;
 const std::int32_t WAVEPATTERN_TYPES = 4;
+// ユーザー定義の音色エンベロープの最大ステップ数
+const std::int32_t COLOR_SEQUENCE_LENGTH = 64;
 const std::int32_t NUM_OF_PRESETS = 12;
 const std::int32_t VOICE_MAX = 8;
 const std::int32_t UP_SAMPLING_FACTOR = 2;
-
-const StringArray OSC_WAVE_TYPES {
-  "NES_Square50%",    "NES_Square25%",  "NES_Square12.5%",
-  "NES_Triangle",     "NES_LongNoise",  "NES_ShortNoise",
-  "Pure_Square50%",   "Pure_Square25%",
-  "Pure_Square12.5%", "Pure_Triangle",
-  "Pure_Sine",        "Pure_Saw",       "Pure_Noise",       
-  "Rough_Sine",       "Rough_Saw",      "Rough_Noise",      
-  "Waveform Memory",
-};
-
-const StringArray OSC_COLOR_TYPES {
-  "NONE",
-  "ARP_Octave",
-  "ARP_4th",
-  "ARP_5th",
-  "ARP_Major",
-  "ARP_Major7th",
-  "ORC_HIT",
-  "ORC_HIT2",
-  "ORC_HIT3",
-};
+// ホストのブロックをこのサンプル数ごとに分割して処理する
+const std::int32_t SUB_BLOCK_SIZE = 64;
+// 自動化で値が変わったパラメータを新しい値まで移動させる時間[秒]
+const double PARAMETER_RAMP_SECONDS = 0.02;
 }
 
 class SynthParametersBase {
@@ -110,10 +95,19 @@ class VibratoParameters : public SynthParametersBase {
 class VoicingParameters : public SynthParametersBase {
  public:
   AudioParameterChoice* VoicingSwitch;
+  // CONSTANT_TIMEではグライドの時間, CONSTANT_RATEでは1オクターブあたりの時間(秒)
   AudioParameterFloat* StepTime;
+  AudioParameterChoice* GlideMode;
+  // 前の音を押したまま次の音を弾いたときにエンベロープをかけ直さない
+  AudioParameterBool* Legato;
+  // MONO / PORTAMENTOで複数のノートが押されているときに鳴らすノート
+  AudioParameterChoice* NotePriority;
 
   VoicingParameters(AudioParameterChoice* sweepSwitch,
-                    AudioParameterFloat* stepTime);
+                    AudioParameterFloat* stepTime,
+                    AudioParameterChoice* glideMode,
+                    AudioParameterBool* legato,
+                    AudioParameterChoice* notePriority);
 
   virtual void addAllParameters(AudioProcessor& processor) override;
   virtual void saveParameters(XmlElement& xml) override;
@@ -127,10 +121,16 @@ class OptionsParameters : public SynthParametersBase {
  public:
   AudioParameterInt* PitchBendRange;
   AudioParameterInt* PitchStandard;
-  float currentBPM;
+  AudioParameterChoice* MacroClock;
+  // ホストのテンポ. processBlockごとに更新する
+  float currentBPM = 120.0f;
 
   OptionsParameters(AudioParameterInt* pitchBendRange,
-                    AudioParameterInt* pitchStandard);
+                    AudioParameterInt* pitchStandard,
+                    AudioParameterChoice* macroClock);
+
+  // ビブラートやスイープなどのマクロを進める1秒あたりのフレーム数. sampleRateはボイスのサンプルレート
+  float getMacroFrameRate(float sampleRate) const;
 
   virtual void addAllParameters(AudioProcessor& processor) override;
   virtual void saveParameters(XmlElement& xml) override;
@@ -193,6 +193,38 @@ class FilterParameters : public SynthParametersBase {
   FilterParameters(){};
 };
 
+class VoiceFilterParameters : public SynthParametersBase {
+ public:
+  AudioParameterBool* FilterEnable;
+  AudioParameterChoice* FilterType;
+  AudioParameterFloat* Cutoff;
+  AudioParameterFloat* Resonance;
+  AudioParameterFloat* KeyTrack;
+  AudioParameterFloat* EnvAmount;
+  AudioParameterFloat* Attack;
+  AudioParameterFloat* Decay;
+  AudioParameterFloat* Sustain;
+  AudioParameterFloat* Release;
+
+  VoiceFilterParameters(AudioParameterBool* filterEnable,
+                        AudioParameterChoice* filterType,
+                        AudioParameterFloat* cutoff,
+                        AudioParameterFloat* resonance,
+                        AudioParameterFloat* keyTrack,
+                        AudioParameterFloat* envAmount,
+                        AudioParameterFloat* attack,
+                        AudioParameterFloat* decay,
+                        AudioParameterFloat* sustain,
+                        AudioParameterFloat* release);
+
+  virtual void addAllParameters(AudioProcessor& processor) override;
+  virtual void saveParameters(XmlElement& xml) override;
+  virtual void loadParameters(XmlElement& xml) override;
+
+ private:
+  VoiceFilterParameters(){};
+};
+
 class PresetsParameters : public SynthParametersBase {
  public:
   AudioParameterInt* ProgramIndex;
@@ -205,6 +237,23 @@ class PresetsParameters : public SynthParametersBase {
  private:
 };
 
+class ColorSequenceParameters : public SynthParametersBase {
+ public:
+  // 各ステップの音程(半音)
+  AudioParameterInt* Steps[COLOR_SEQUENCE_LENGTH];
+  AudioParameterInt* Length;
+  AudioParameterBool* LoopEnabled;
+  AudioParameterInt* LoopStart;
+
+  ColorSequenceParameters();
+
+  virtual void addAllParameters(AudioProcessor& processor) override;
+  virtual void saveParameters(XmlElement& xml) override;
+  virtual void loadParameters(XmlElement& xml) override;
+
+ private:
+};
+
 class WavePatternParameters : public SynthParametersBase {
  public:
   AudioParameterInt* WavePatternArray[WAVEPATTERN_LENGTH];
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <atomic>
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+// オーディオスレッドのイベントを記録する. 既定ではデバッグビルドのみ組み込む.
+// 0にすると記録用のマクロは空になり, プロセッサのメンバとエディタのTraceボタンも組み込まれない.
+// 組み込んだ場合も start を呼ぶまではバッファを確保せず, 書き出しスレッドも起動しない
+#ifndef SANA_ENABLE_TRACE
+#define SANA_ENABLE_TRACE JUCE_DEBUG
+#endif
+
+#if SANA_ENABLE_TRACE
+#define SANA_TRACE_SCOPE(recorder, name, track) \
+  TraceRecorder::ScopedEvent JUCE_JOIN_MACRO(traceScope_, __LINE__)(recorder, name, track)
+#define SANA_TRACE_INSTANT(recorder, name, track, arg0, arg1) \
+  do { if ((recorder) != nullptr) (recorder)->instant(name, track, arg0, arg1); } while (false)
+#define SANA_TRACE_COUNTER(recorder, name, value) \
+  do { if ((recorder) != nullptr) (recorder)->counter(name, value); } while (false)
+#else
+#define SANA_TRACE_SCOPE(recorder, name, track)
+#define SANA_TRACE_INSTANT(recorder, name, track, arg0, arg1)
+#define SANA_TRACE_COUNTER(recorder, name, value)
+#endif
+
+/*
+--------------------------------------------------------------------------------
+TraceRecorder
+オーディオスレッドの開始/終了/瞬間/カウンタのイベントを事前確保したリングバッファへ記録し,
+バックグラウンドスレッドがChromeのトレース形式(JSON)でファイルへ書き出す.
+chrome://tracing や https://ui.perfetto.dev で開ける.
+書き込みはオーディオスレッド1本, 読み出しは書き出しスレッド1本の前提でロックを取らない.
+イベント名は文字列リテラルなど寿命の長い文字列のみ渡すこと.
+--------------------------------------------------------------------------------
+*/
+class TraceRecorder : private juce::Thread {
+ public:
+  static constexpr std::int32_t CAPACITY = 1 << 16;
+  // トラック番号. ボイスは VOICE_TRACK_OFFSET + ボイス番号 を使う
+  static constexpr std::int32_t PROCESSOR_TRACK = 0;
+  static constexpr std::int32_t VOICE_TRACK_OFFSET = 1;
+
+  class ScopedEvent {
+   public:
+    ScopedEvent(TraceRecorder* recorder, const char* name, std::int32_t track)
+        : _recorder(recorder), _name(name), _track(track) {
+      if (_recorder != nullptr) {
+        _recorder->begin(_name, _track);
+      }
+    }
+    ~ScopedEvent() {
+      if (_recorder != nullptr) {
+        _recorder->end(_name, _track);
+      }
+    }
+
+   private:
+    TraceRecorder* _recorder;
+    const char* _name;
+    std::int32_t _track;
+  };
+
+  TraceRecorder() : juce::Thread("SANA Trace Writer") {}
+
+  ~TraceRecorder() { stop(); }
+
+  // 以下はメッセージスレッドから呼ぶ
+  bool start(const File& file) {
+#if SANA_ENABLE_TRACE
+    stop();
+
+    file.deleteFile();
+    _stream.reset(new FileOutputStream(file));
+    if (!_stream->openedOk()) {
+      _stream.reset();
+      return false;
+    }
+    _file = file;
+
+    // 最初の記録で確保する. 記録中でなければオーディオスレッドは_eventsに触れない
+    if (_events == nullptr) {
+      _events.calloc((size_t)CAPACITY);
+    }
+
+    // 前回の残りを捨ててから記録を始める
+    int start1, size1, start2, size2;
+    _fifo.prepareToRead(_fifo.getNumReady(), start1, size1, start2, size2);
+    _fifo.finishedRead(size1 + size2);
+
+    _startTicks = Time::getHighResolutionTicks();
+    _numWritten = 0;
+    _numDropped.store(0);
+    *_stream << "{\"traceEvents\":[\n";
+
+    startThread();
+    _isRecording.store(true, std::memory_order_release);
+    return true;
+#else
+    ignoreUnused(file);
+    return false;
+#endif
+  }
+
+  void stop() {
+    if (!_isRecording.exchange(false)) {
+      return;
+    }
+
+    // 書き出しスレッドが残りを書き切ってから閉じる
+    signalThreadShouldExit();
+    notify();
+    stopThread(2000);
+
+    *_stream << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" << (int)_numDropped.load()
+             << "}}\n";
+    _stream->flush();
+    _stream.reset();
+  }
+
+  bool isRecording() const { return _isRecording.load(std::memory_order_acquire); }
+  const File& getFile() const { return _file; }
+
+  // 以下はオーディオスレッドから呼ぶ
+  void begin(const char* name, std::int32_t track) { push('B', name, track, 0.0f, 0.0f); }
+  void end(const char* name, std::int32_t track) { push('E', name, track, 0.0f, 0.0f); }
+  void instant(const char* name, std::int32_t track, float arg0, float arg1) { push('i', name, track, arg0, arg1); }
+  void counter(const char* name, float value) { push('C', name, PROCESSOR_TRACK, value, 0.0f); }
+
+ private:
+  struct Event {
+    std::int64_t ticks;
+    const char* name;
+    std::int32_t track;
+    char phase;
+    float arg0, arg1;
+  };
+
+  void push(char phase, const char* name, std::int32_t track, float arg0, float arg1) {
+    if (!_isRecording.load(std::memory_order_acquire)) {
+      return;
+    }
+
+    int start1, size1, start2, size2;
+    _fifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 <= 0) {
+      _numDropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    auto& event = _events[(size_t)start1];
+    event.ticks = Time::getHighResolutionTicks();
+    event.name = name;
+    event.track = track;
+    event.phase = phase;
+    event.arg0 = arg0;
+    event.arg1 = arg1;
+    _fifo.finishedWrite(1);
+  }
+
+  void run() override {
+    while (!threadShouldExit()) {
+      drain();
+      wait(50);
+    }
+    drain();
+  }
+
+  void drain() {
+    int start1, size1, start2, size2;
+    _fifo.prepareToRead(_fifo.getNumReady(), start1, size1, start2, size2);
+    for (auto i = start1; i < start1 + size1; ++i) {
+      writeEvent(_events[(size_t)i]);
+    }
+    for (auto i = start2; i < start2 + size2; ++i) {
+      writeEvent(_events[(size_t)i]);
+    }
+    _fifo.finishedRead(size1 + size2);
+  }
+
+  void writeEvent(const Event& event) {
+    const auto microseconds =
+        Time::highResolutionTicksToSeconds(event.ticks - _startTicks) * 1.0e6;
+
+    auto& out = *_stream;
+    out << (_numWritten++ == 0 ? "" : ",\n");
+    out << "{\"name\":\"" << event.name << "\",\"ph\":\"" << String::charToString(event.phase)
+        << "\",\"ts\":" << String(microseconds, 3) << ",\"pid\":1,\"tid\":" << (int)event.track;
+
+    switch (event.phase) {
+      case 'i':
+        out << ",\"s\":\"t\",\"args\":{\"a\":" << String(event.arg0) << ",\"b\":" << String(event.arg1) << "}";
+        break;
+      case 'C':
+        out << ",\"args\":{\"value\":" << String(event.arg0) << "}";
+        break;
+      default:
+        break;
+    }
+    out << "}";
+  }
+
+  HeapBlock<Event> _events;
+  AbstractFifo _fifo{CAPACITY};
+
+  std::atomic<bool> _isRecording{false};
+  std::atomic<std::int32_t> _numDropped{0};
+
+  // 書き出しスレッド側
+  std::unique_ptr<FileOutputStream> _stream;
+  File _file;
+  std::int64_t _startTicks = 0;
+  std::int64_t _numWritten = 0;
+};
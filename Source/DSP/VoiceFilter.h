@@ -0,0 +1,172 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "SynthParameters.h"
+
+/*
+--------------------------------------------------------------------------------
+VoiceFilterBank
+ボイスごとのフィルタ(TPT State Variable Filter)をまとめて処理するクラス.
+各ボイスをSIMDレジスタの1レーンに割り当てて全ボイス分を同時に計算するため,
+発音数が増えてもスカラーのフィルタ1本分に近いコストで済む.
+基準のカットオフ周波数は, 変わったときだけPARAMETER_RAMP_SECONDSかけて係数の更新ごとに対数で移動する.
+https://cytomic.com/files/dsp/SvfLinearTrapOptimised2.pdf
+--------------------------------------------------------------------------------
+*/
+class VoiceFilterBank {
+ public:
+  using SIMDFloat = dsp::SIMDRegister<float>;
+
+  static constexpr std::int32_t NUM_LANES = VOICE_MAX;
+  static constexpr std::int32_t LANES_PER_REGISTER = (std::int32_t)SIMDFloat::SIMDNumElements;
+  static constexpr std::int32_t NUM_REGISTERS = (NUM_LANES + LANES_PER_REGISTER - 1) / LANES_PER_REGISTER;
+  // 1サンプル当たりのレーン数(SIMDレジスタの倍数に揃える)
+  static constexpr std::int32_t LANE_STRIDE = NUM_REGISTERS * LANES_PER_REGISTER;
+  // カットオフ周波数から係数を再計算する間隔(サンプル数)
+  static constexpr std::int32_t CONTROL_INTERVAL = 16;
+
+  VoiceFilterBank(){};
+
+  void prepare(double sampleRate, std::int32_t maxNumSamples) {
+    _sampleRate = (float)sampleRate;
+    _capacity = std::max(maxNumSamples, 1);
+
+    // SIMDのアライメントに揃えるため1レジスタ分余分に確保する
+    const auto numElements = (size_t)(_capacity * LANE_STRIDE + LANES_PER_REGISTER);
+    _inputData.allocate(numElements, true);
+    _cutoffData.allocate(numElements, true);
+    _input = SIMDFloat::getNextSIMDAlignedPtr(_inputData.get());
+    _cutoff = SIMDFloat::getNextSIMDAlignedPtr(_cutoffData.get());
+
+    _baseCutoff.reset(sampleRate, PARAMETER_RAMP_SECONDS);
+    // 次のsetParametersでは移動せずに値を設定する
+    _hasParameters = false;
+    reset();
+  }
+
+  void reset() {
+    for (auto r = 0; r < NUM_REGISTERS; ++r) {
+      _ic1eq[r] = SIMDFloat::expand(0.0f);
+      _ic2eq[r] = SIMDFloat::expand(0.0f);
+      _a1[r] = SIMDFloat::expand(0.0f);
+      _a2[r] = SIMDFloat::expand(0.0f);
+      _a3[r] = SIMDFloat::expand(0.0f);
+    }
+  }
+
+  // 発音を始めるボイスのフィルタ状態だけを初期化する
+  void resetLane(std::int32_t lane) {
+    jassert(lane >= 0 && lane < NUM_LANES);
+    const auto r = (size_t)(lane / LANES_PER_REGISTER);
+    const auto index = (size_t)(lane % LANES_PER_REGISTER);
+    _ic1eq[r].set(index, 0.0f);
+    _ic2eq[r].set(index, 0.0f);
+  }
+
+  void setParameters(bool isEnabled, VOICE_FILTER_TYPE type, float cutoff, float resonance) {
+    _isEnabled = isEnabled;
+    if (_hasParameters) {
+      _baseCutoff.setTargetValue(cutoff);
+    } else {
+      _baseCutoff.setCurrentAndTargetValue(cutoff);
+      _hasParameters = true;
+    }
+    _k = 1.0f / jmax(resonance, MIN_RESONANCE);
+
+    // 出力 = m0 * 入力 + m1 * バンドパス + m2 * ローパス
+    const auto& info = getVoiceFilterTypeInfo(type);
+    _m0 = info.inputMix;
+    _m1 = info.bandMix * _k;
+    _m2 = info.lowMix;
+  }
+
+  bool isEnabled() const { return _isEnabled; }
+  std::int32_t getCapacity() const { return _capacity; }
+
+  // ボイスの書き込み先を0で初期化する. ボイスのレンダリング前に呼ぶ
+  void beginBlock(std::int32_t numSamples) {
+    jassert(numSamples <= _capacity);
+    FloatVectorOperations::clear(_input, std::min(numSamples, _capacity) * LANE_STRIDE);
+  }
+
+  // ボイスの出力をレーンに加算する
+  void addSample(std::int32_t lane, std::int32_t sampleIndex, float value) {
+    jassert(sampleIndex < _capacity);
+    _input[sampleIndex * LANE_STRIDE + lane] += value;
+  }
+
+  // カットオフ周波数の変化量をオクターブ単位でレーンに書き込む
+  void setCutoffOffset(std::int32_t lane, std::int32_t sampleIndex, float octave) {
+    jassert(sampleIndex < _capacity);
+    _cutoff[sampleIndex * LANE_STRIDE + lane] = octave;
+  }
+
+  // 全レーンにフィルタをかけ, 合計を出力バッファの全チャンネルに加算する
+  void process(AudioBuffer<float>& outputBuffer, std::int32_t startSample, std::int32_t numSamples) {
+    numSamples = std::min(numSamples, _capacity);
+    const auto numChannels = outputBuffer.getNumChannels();
+
+    for (auto i = 0; i < numSamples; ++i) {
+      if (i % CONTROL_INTERVAL == 0) {
+        updateCoefficients(i, _baseCutoff.skip(jmin(CONTROL_INTERVAL, numSamples - i)));
+      }
+
+      const float* in = _input + i * LANE_STRIDE;
+      auto sum = SIMDFloat::expand(0.0f);
+      for (auto r = 0; r < NUM_REGISTERS; ++r) {
+        const auto v0 = SIMDFloat::fromRawArray(in + r * LANES_PER_REGISTER);
+        const auto v3 = v0 - _ic2eq[r];
+        const auto v1 = _a1[r] * _ic1eq[r] + _a2[r] * v3;
+        const auto v2 = _ic2eq[r] + _a2[r] * _ic1eq[r] + _a3[r] * v3;
+        _ic1eq[r] = v1 * 2.0f - _ic1eq[r];
+        _ic2eq[r] = v2 * 2.0f - _ic2eq[r];
+        sum += v0 * _m0 + v1 * _m1 + v2 * _m2;
+      }
+
+      const auto out = sum.sum();
+      for (auto channel = 0; channel < numChannels; ++channel) {
+        outputBuffer.addSample(channel, startSample + i, out);
+      }
+    }
+  }
+
+ private:
+  static constexpr float MIN_CUTOFF = 20.0f;
+  static constexpr float MIN_RESONANCE = 0.1f;
+
+  void updateCoefficients(std::int32_t sampleIndex, float baseCutoff) {
+    const float* cutoff = _cutoff + sampleIndex * LANE_STRIDE;
+    const auto maxCutoff = _sampleRate * 0.49f;
+
+    for (auto lane = 0; lane < LANE_STRIDE; ++lane) {
+      const auto freq = jlimit(MIN_CUTOFF, maxCutoff, baseCutoff * std::exp2(cutoff[lane]));
+      const auto g = std::tan(MathConstants<float>::pi * freq / _sampleRate);
+      const auto a1 = 1.0f / (1.0f + g * (g + _k));
+      const auto a2 = g * a1;
+      const auto a3 = g * a2;
+
+      const auto r = (size_t)(lane / LANES_PER_REGISTER);
+      const auto index = (size_t)(lane % LANES_PER_REGISTER);
+      _a1[r].set(index, a1);
+      _a2[r].set(index, a2);
+      _a3[r].set(index, a3);
+    }
+  }
+
+  // フィルタ状態と係数. レーン方向にSIMDレジスタへ詰めて保持する
+  SIMDFloat _ic1eq[NUM_REGISTERS], _ic2eq[NUM_REGISTERS];
+  SIMDFloat _a1[NUM_REGISTERS], _a2[NUM_REGISTERS], _a3[NUM_REGISTERS];
+
+  // サンプルごとに [レーン0, レーン1, ...] の順で並べたボイス出力とカットオフ
+  HeapBlock<float> _inputData, _cutoffData;
+  float* _input = nullptr;
+  float* _cutoff = nullptr;
+  std::int32_t _capacity = 0;
+
+  bool _isEnabled = false;
+  float _sampleRate = 44100.0f;
+  SmoothedValue<float, ValueSmoothingTypes::Multiplicative> _baseCutoff{20000.0f};
+  bool _hasParameters = false;
+  float _k = 1.414f;
+  float _m0 = 0.0f, _m1 = 0.0f, _m2 = 1.0f;
+};
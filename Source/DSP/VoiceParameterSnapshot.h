@@ -0,0 +1,126 @@
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "ColorTable.h"
+#include "SynthParameters.h"
+
+/*
+--------------------------------------------------------------------------------
+VoiceParameterSnapshot
+ボイスのレンダリングで使うパラメータを, プロセッサがサブブロックごとに1回だけ読み込んでおく.
+MIDIイベントでレンダリングが細かく区切られても, ボイスはパラメータを読み直さずにこの値を使う.
+serialはどれかの値が変わったときだけ増え, ボイスは前回と違うときだけエンベロープなどを設定し直す.
+--------------------------------------------------------------------------------
+*/
+struct VoiceParameterSnapshot {
+  std::uint32_t serial = 0;
+
+  WaveKernel waveKernel = WAVE_TYPE_INFOS[0].kernel;
+
+  // アンプエンベロープ
+  float attack = 0.0f;
+  float decay = 0.0f;
+  float sustain = 1.0f;
+  float release = 0.0f;
+
+  // 音色エンベロープ. ColorEnvelopeはパラメータとColorTableBankを直接読むため, 変化の検出にだけ使う
+  COLOR_TYPE colorType = COLOR_TYPE::NONE;
+  float colorDuration = 0.0f;
+  std::int32_t userColorLength = 0;
+  std::int32_t userColorLoopStart = 0;
+
+  // エコー
+  bool isEchoEnabled = false;
+  float echoDuration = 0.1f;
+  std::int32_t echoRepeat = 1;
+  float echoVolume = 0.5f;
+
+  // ビブラート
+  bool isVibratoEnabled = false;
+  bool isVibratoAttackDelayEnabled = true;
+  float vibratoAmount = 0.0f;
+  float vibratoSpeed = 0.0f;
+  float vibratoAttackTime = 0.0f;
+
+  // スイープ
+  SWEEP_TYPE sweepType = SWEEP_TYPE::OFF;
+  float sweepTime = 1.0f;
+
+  // 波形パターン
+  bool isPatternEnabled = false;
+  bool isPatternLoopEnabled = false;
+  float patternStepTime = 0.1f;
+
+  // オプション
+  std::int32_t pitchBendRange = 2;
+  float frameRate = 60.0f;
+
+  // ボイスフィルタ
+  float filterKeyTrack = 0.0f;
+  float filterEnvAmount = 0.0f;
+  float filterAttack = 0.0f;
+  float filterDecay = 0.0f;
+  float filterSustain = 1.0f;
+  float filterRelease = 0.0f;
+
+  void update(const ChipOscillatorParameters& chipOsc, const SweepParameters& sweep, const VibratoParameters& vibrato,
+              const OptionsParameters& options, const MidiEchoParameters& midiEcho,
+              const WavePatternParameters& wavePattern, const VoiceFilterParameters& voiceFilter,
+              const ColorTableBank& colorTable, float sampleRate) {
+    auto isChanged = false;
+
+    assign(waveKernel, getWaveTypeInfo(toChipType<WAVE_TYPE>(chipOsc.OscWaveType)).kernel, isChanged);
+
+    assign(attack, chipOsc.Attack->get(), isChanged);
+    assign(decay, chipOsc.Decay->get(), isChanged);
+    assign(sustain, chipOsc.Sustain->get(), isChanged);
+    assign(release, chipOsc.Release->get(), isChanged);
+
+    assign(colorType, toChipType<COLOR_TYPE>(chipOsc.ColorType), isChanged);
+    assign(colorDuration, chipOsc.ColorDuration->get(), isChanged);
+    const auto& userSequence = colorTable.getSequence(COLOR_TYPE::USER);
+    assign(userColorLength, userSequence.length, isChanged);
+    assign(userColorLoopStart, userSequence.loopStart, isChanged);
+
+    assign(isEchoEnabled, midiEcho.IsEchoEnable->get(), isChanged);
+    assign(echoDuration, midiEcho.EchoDuration->get(), isChanged);
+    assign(echoRepeat, midiEcho.EchoRepeat->get(), isChanged);
+    assign(echoVolume, midiEcho.VolumeOffset->get() / 100.0f, isChanged);
+
+    assign(isVibratoEnabled, vibrato.VibratoEnable->get(), isChanged);
+    assign(isVibratoAttackDelayEnabled, vibrato.VibratoAttackDeleySwitch->get(), isChanged);
+    assign(vibratoAmount, vibrato.VibratoAmount->get(), isChanged);
+    assign(vibratoSpeed, vibrato.VibratoSpeed->get(), isChanged);
+    assign(vibratoAttackTime, vibrato.VibratoAttackTime->get(), isChanged);
+
+    assign(sweepType, toChipType<SWEEP_TYPE>(sweep.SweepSwitch), isChanged);
+    assign(sweepTime, sweep.SweepTime->get(), isChanged);
+
+    assign(isPatternEnabled, wavePattern.PatternEnabled->get(), isChanged);
+    assign(isPatternLoopEnabled, wavePattern.LoopEnabled->get(), isChanged);
+    assign(patternStepTime, wavePattern.StepTime->get(), isChanged);
+
+    assign(pitchBendRange, options.PitchBendRange->get(), isChanged);
+    assign(frameRate, options.getMacroFrameRate(sampleRate), isChanged);
+
+    assign(filterKeyTrack, voiceFilter.KeyTrack->get(), isChanged);
+    assign(filterEnvAmount, voiceFilter.EnvAmount->get(), isChanged);
+    assign(filterAttack, voiceFilter.Attack->get(), isChanged);
+    assign(filterDecay, voiceFilter.Decay->get(), isChanged);
+    assign(filterSustain, voiceFilter.Sustain->get(), isChanged);
+    assign(filterRelease, voiceFilter.Release->get(), isChanged);
+
+    if (isChanged) {
+      ++serial;
+    }
+  }
+
+ private:
+  template <typename T, typename U>
+  static void assign(T& field, U value, bool& isChanged) {
+    if (field != (T)value) {
+      field = (T)value;
+      isChanged = true;
+    }
+  }
+};
@@ -193,4 +193,35 @@ float Waveforms::high_pass(float in) {
   auto out = in - _capacitor;
   _capacitor = in - out * 0.996;
   return out;
-}
\ No newline at end of file
+}
+
+//-----------------------------------------------------------------------------------------
+// WAVE_TYPE_INFOSから呼ばれる波形関数
+
+namespace WaveKernels {
+float nesSquare50(Waveforms& w, float angle, float, WaveformMemoryParameters*) { return w.nesSquare(angle); }
+float nesSquare25(Waveforms& w, float angle, float, WaveformMemoryParameters*) { return w.nesSquare25(angle); }
+float nesSquare125(Waveforms& w, float angle, float, WaveformMemoryParameters*) { return w.nesSquare125(angle); }
+float nesTriangle(Waveforms& w, float angle, float, WaveformMemoryParameters*) { return w.nesTriangle(angle); }
+float nesLongNoise(Waveforms& w, float, float angleDelta, WaveformMemoryParameters*) {
+  return w.longNoise(angleDelta);
+}
+float nesShortNoise(Waveforms& w, float, float angleDelta, WaveformMemoryParameters*) {
+  return w.shortNoise(angleDelta);
+}
+float pureSquare50(Waveforms& w, float angle, float, WaveformMemoryParameters*) { return w.square(angle); }
+float pureSquare25(Waveforms& w, float angle, float, WaveformMemoryParameters*) { return w.square25(angle); }
+float pureSquare125(Waveforms& w, float angle, float, WaveformMemoryParameters*) { return w.square125(angle); }
+float pureTriangle(Waveforms& w, float angle, float, WaveformMemoryParameters*) { return w.triangle(angle); }
+float pureSine(Waveforms& w, float angle, float, WaveformMemoryParameters*) { return w.sine(angle); }
+float pureSaw(Waveforms& w, float angle, float, WaveformMemoryParameters*) { return w.saw(angle); }
+float pureNoise(Waveforms& w, float, float angleDelta, WaveformMemoryParameters*) { return w.noise(angleDelta); }
+float roughSine(Waveforms& w, float angle, float, WaveformMemoryParameters*) { return w.roughSine(angle); }
+float roughSaw(Waveforms& w, float angle, float, WaveformMemoryParameters*) { return w.roughSaw(angle); }
+float roughNoise(Waveforms& w, float, float angleDelta, WaveformMemoryParameters*) {
+  return w.lobitNoise(angleDelta);
+}
+float waveformMemory(Waveforms& w, float angle, float, WaveformMemoryParameters* m) {
+  return w.waveformMemory(angle, m);
+}
+}  // namespace WaveKernels
@@ -18,6 +18,12 @@ EditorGUI::EditorGUI(PluginProcessor &p)
                         MidiKeyboardComponent::Orientation::horizontalKeyboard),
       OscButton("Wave", this),
       EffectButton("Effects", this),
+#if SANA_ENABLE_PROFILER
+      ProfilerButton("Profiler", this),
+#endif
+#if SANA_ENABLE_TRACE
+      TraceButton("Trace", this),
+#endif
       chipOscComponent(&p.chipOscParameters),
       sweepParamsComponent(&p.sweepParameters),
       vibratoParamsComponent(&p.vibratoParameters),
@@ -26,7 +32,11 @@ EditorGUI::EditorGUI(PluginProcessor &p)
       waveformMemoryParamsComponent(&p.waveformMemoryParameters),
       midiEchoParamsComponent(&p.midiEchoParameters),
       filterParamsComponent(&p.filterParameters),
+      voiceFilterParamsComponent(&p.voiceFilterParameters),
       wavePatternsComponent(&p.wavePatternParameters),
+#if SANA_ENABLE_PROFILER
+      profilerComponent(p.getStageProfiler()),
+#endif
       scopeComponent(p.getAudioBufferQueue()) {
   /*
           TabComponentを使いたかったが，Tabだとメモリリークが収まらないので現在の形に．
@@ -41,8 +51,25 @@ EditorGUI::EditorGUI(PluginProcessor &p)
 
     addAndMakeVisible(OscButton);
     addAndMakeVisible(EffectButton);
+#if SANA_ENABLE_PROFILER
+    addAndMakeVisible(ProfilerButton);
+#endif
+#if SANA_ENABLE_TRACE
+    addAndMakeVisible(TraceButton);
+#endif
     OscButton.setToggleState(true);
     EffectButton.setToggleState(false);
+#if SANA_ENABLE_PROFILER
+    ProfilerButton.setToggleState(false);
+#endif
+#if SANA_ENABLE_TRACE
+    TraceButton.setToggleState(processor.getTraceRecorder().isRecording());
+#endif
+
+#if SANA_ENABLE_PROFILER
+    // 最前面に重ねて表示する. 初期状態は非表示
+    addChildComponent(profilerComponent);
+#endif
   }
   {
     addAndMakeVisible(chipOscComponent);
@@ -57,6 +84,7 @@ EditorGUI::EditorGUI(PluginProcessor &p)
   {
     addAndMakeVisible(midiEchoParamsComponent);
     addAndMakeVisible(filterParamsComponent);
+    addAndMakeVisible(voiceFilterParamsComponent);
     addAndMakeVisible(scopeComponent);
   }
 
@@ -107,10 +135,16 @@ EditorGUI::EditorGUI(PluginProcessor &p)
     waveformMemoryParamsComponent.setVisible(true);
     midiEchoParamsComponent.setVisible(false);
     filterParamsComponent.setVisible(false);
+    voiceFilterParamsComponent.setVisible(false);
   }
+
+  // オーディオスレッドで鳴っているノートを鍵盤の表示へ反映する
+  startTimerHz(30);
 }
 
 EditorGUI::~EditorGUI() {
+  stopTimer();
+
   for (Component* child : getChildren()) {
     child->setLookAndFeel(nullptr);
   }
@@ -137,8 +171,18 @@ void EditorGUI::resized() {
     Rectangle<int> area = bounds.removeFromTop(40);
     OscButton.setBounds(area.removeFromLeft(80));
     EffectButton.setBounds(area.removeFromLeft(80));
+#if SANA_ENABLE_PROFILER
+    ProfilerButton.setBounds(area.removeFromLeft(80));
+#endif
+#if SANA_ENABLE_TRACE
+    TraceButton.setBounds(area.removeFromLeft(80));
+#endif
   }
 
+#if SANA_ENABLE_PROFILER
+  profilerComponent.setBounds(bounds.withSizeKeepingCentre(560, 190));
+#endif
+
   // Oscillator Page
   if (OscButton.button.getToggleState() == true) {
     Rectangle<int> mainbounds = bounds;
@@ -169,7 +213,7 @@ void EditorGUI::resized() {
     }
     {
       Rectangle<int> rightArea = mainbounds;
-      auto boundsHeight = rightArea.getHeight() / 3.f;
+      auto boundsHeight = rightArea.getHeight() / 4.5f;
       auto boundsWidth = rightArea.getWidth() / 2.f;
       {
         auto bounds = rightArea.removeFromTop(boundsHeight);
@@ -181,6 +225,7 @@ void EditorGUI::resized() {
         midiEchoParamsComponent.setBounds(bounds.removeFromLeft(boundsWidth));
         filterParamsComponent.setBounds(bounds);
       }
+      voiceFilterParamsComponent.setBounds(rightArea.removeFromTop(boundsHeight * 1.5f));
       {
         auto bounds = rightArea.removeFromTop(boundsHeight);
         voicingParamsComponent.setBounds(bounds.removeFromLeft(boundsWidth));
@@ -191,6 +236,34 @@ void EditorGUI::resized() {
 }
 
 void EditorGUI::buttonClicked(Button* button) {
+#if SANA_ENABLE_PROFILER
+  // プロファイラはページとは独立して重ねて表示する
+  if (button == &ProfilerButton.button) {
+    const auto isVisible = !profilerComponent.isVisible();
+    profilerComponent.setVisible(isVisible);
+    profilerComponent.toFront(false);
+    ProfilerButton.setToggleState(isVisible);
+    return;
+  }
+#endif
+
+#if SANA_ENABLE_TRACE
+  // トレースの記録を開始/停止する. ファイルは書類フォルダに保存する
+  if (button == &TraceButton.button) {
+    auto& recorder = processor.getTraceRecorder();
+    if (recorder.isRecording()) {
+      recorder.stop();
+      DBG("Trace saved: " + recorder.getFile().getFullPathName());
+    } else {
+      auto directory = File::getSpecialLocation(File::userDocumentsDirectory).getChildFile("SANA_8BIT_VST");
+      directory.createDirectory();
+      recorder.start(directory.getChildFile("trace_" + Time::getCurrentTime().formatted("%Y%m%d_%H%M%S") + ".json"));
+    }
+    TraceButton.setToggleState(recorder.isRecording());
+    return;
+  }
+#endif
+
   {
     chipOscComponent.setVisible(false);
     sweepParamsComponent.setVisible(false);
@@ -200,6 +273,7 @@ void EditorGUI::buttonClicked(Button* button) {
     waveformMemoryParamsComponent.setVisible(false);
     midiEchoParamsComponent.setVisible(false);
     filterParamsComponent.setVisible(false);
+    voiceFilterParamsComponent.setVisible(false);
     scopeComponent.setVisible(false);
     wavePatternsComponent.setVisible(false);
 
@@ -222,10 +296,15 @@ void EditorGUI::buttonClicked(Button* button) {
     vibratoParamsComponent.setVisible(true);
     midiEchoParamsComponent.setVisible(true);
     filterParamsComponent.setVisible(true);
+    voiceFilterParamsComponent.setVisible(true);
     voicingParamsComponent.setVisible(true);
     optionsParamsComponent.setVisible(true);
 
     EffectButton.setToggleState(true);
   }
   resized();
-}
\ No newline at end of file
+}
+
+void EditorGUI::timerCallback() {
+  processor.getKeyboardBridge().syncToKeyboardState(keyboardComponent.getMidiChannel());
+}
@@ -2,12 +2,18 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "GUI/ParametersComponent.h"
+#include "DSP/StageProfiler.h"
+#include "DSP/TraceRecorder.h"
+#if SANA_ENABLE_PROFILER
+#include "GUI/ProfilerComponent.hpp"
+#endif
 #include "GUI/ScopeComponent.hpp"
 
 class PluginProcessor;
 
 class EditorGUI : public AudioProcessorEditor,
-                                        public Button::Listener {
+                                        public Button::Listener,
+                                        private juce::Timer {
  public:
   EditorGUI(PluginProcessor & p);
   ~EditorGUI();
@@ -16,12 +22,20 @@ class EditorGUI : public AudioProcessorEditor,
   void buttonClicked(Button* button) override;
 
  private:
+  void timerCallback() override;
+
   PluginProcessor & processor;
 
   MidiKeyboardComponent keyboardComponent;
 
   PageButton OscButton;
   PageButton EffectButton;
+#if SANA_ENABLE_PROFILER
+  PageButton ProfilerButton;
+#endif
+#if SANA_ENABLE_TRACE
+  PageButton TraceButton;
+#endif
 
   // Oscillator Page Component
   ScopeComponent<float> scopeComponent;
@@ -34,10 +48,16 @@ class EditorGUI : public AudioProcessorEditor,
   // Effects Page Component
   MidiEchoParametersComponent midiEchoParamsComponent;
   FilterParametersComponent filterParamsComponent;
+  VoiceFilterParametersComponent voiceFilterParamsComponent;
 
   LookAndFeel* customLookAndFeel;
 
   WavePatternsComponent wavePatternsComponent;
 
+#if SANA_ENABLE_PROFILER
+  // 処理時間のオーバーレイ. ProfilerButtonで表示を切り替える
+  ProfilerComponent profilerComponent;
+#endif
+
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EditorGUI)
 };
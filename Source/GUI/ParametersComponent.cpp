@@ -335,10 +335,16 @@ VoicingParametersComponent::VoicingParametersComponent(
     VoicingParameters* voicingParams)
     : _voicingParamsPtr(voicingParams),
       voicingTypeSelector("Type", _voicingParamsPtr->VoicingSwitch, this),
+      glideModeSelector("Glide", _voicingParamsPtr->GlideMode, this),
       stepTimeSlider("StepTime", "sec", _voicingParamsPtr->StepTime, this,
-                     0.001f, 0.5f) {
+                     0.001f, 0.5f),
+      legatoSwitch("Legato", _voicingParamsPtr->Legato, this),
+      notePrioritySelector("Priority", _voicingParamsPtr->NotePriority, this) {
   addAndMakeVisible(voicingTypeSelector);
+  addAndMakeVisible(glideModeSelector);
   addAndMakeVisible(stepTimeSlider);
+  addAndMakeVisible(legatoSwitch);
+  addAndMakeVisible(notePrioritySelector);
 }
 
 void VoicingParametersComponent::paint(Graphics& g) {
@@ -346,7 +352,7 @@ void VoicingParametersComponent::paint(Graphics& g) {
 }
 
 void VoicingParametersComponent::resized() {
-  float rowSize = 2.0f;
+  float rowSize = 5.0f;
   float divide = 1.0f / rowSize;
   std::int32_t compHeight =
       std::int32_t((getHeight() - HEADER_HEIGHT) * divide);
@@ -356,24 +362,32 @@ void VoicingParametersComponent::resized() {
 
   {
     auto alpha = 0.0f;
-    if (_voicingParamsPtr->VoicingSwitch->getCurrentChoiceName() ==
-            "PORTAMENTO" ||
-        _voicingParamsPtr->VoicingSwitch->getCurrentChoiceName() ==
-            "ARPEGGIO") {
+    if (toChipType<VOICING_TYPE>(_voicingParamsPtr->VoicingSwitch) == VOICING_TYPE::PORTAMENTO) {
       alpha = 1.0f;
     } else {
       alpha = 0.4f;
     }
+    glideModeSelector.setAlpha(alpha);
     stepTimeSlider.setAlpha(alpha);
+    const auto monoAlpha =
+        toChipType<VOICING_TYPE>(_voicingParamsPtr->VoicingSwitch) == VOICING_TYPE::POLY ? 0.4f : 1.0f;
+    legatoSwitch.setAlpha(monoAlpha);
+    notePrioritySelector.setAlpha(monoAlpha);
   }
   voicingTypeSelector.setBounds(bounds.removeFromTop(compHeight));
+  glideModeSelector.setBounds(bounds.removeFromTop(compHeight));
   stepTimeSlider.setBounds(bounds.removeFromTop(compHeight));
+  legatoSwitch.setBounds(bounds.removeFromTop(compHeight));
+  notePrioritySelector.setBounds(bounds.removeFromTop(compHeight));
 }
 
 void VoicingParametersComponent::timerCallback() {
   voicingTypeSelector.setSelectedItemIndex(
       _voicingParamsPtr->VoicingSwitch->getIndex());
+  glideModeSelector.setSelectedItemIndex(_voicingParamsPtr->GlideMode->getIndex());
   stepTimeSlider.setValue(_voicingParamsPtr->StepTime->get());
+  legatoSwitch.setToggleState(_voicingParamsPtr->Legato->get());
+  notePrioritySelector.setSelectedItemIndex(_voicingParamsPtr->NotePriority->getIndex());
 }
 
 void VoicingParametersComponent::sliderValueChanged(Slider* slider) {
@@ -387,17 +401,29 @@ void VoicingParametersComponent::comboBoxChanged(
   if (comboBoxThatHasChanged == &voicingTypeSelector.selector) {
     *_voicingParamsPtr->VoicingSwitch =
         voicingTypeSelector.getSelectedItemIndex();
+  } else if (comboBoxThatHasChanged == &glideModeSelector.selector) {
+    *_voicingParamsPtr->GlideMode = glideModeSelector.getSelectedItemIndex();
+  } else if (comboBoxThatHasChanged == &notePrioritySelector.selector) {
+    *_voicingParamsPtr->NotePriority = notePrioritySelector.getSelectedItemIndex();
   }
   resized();
 }
 
+void VoicingParametersComponent::buttonClicked(Button* button) {
+  if (button == &legatoSwitch.button) {
+    *_voicingParamsPtr->Legato = legatoSwitch.getToggleState();
+  }
+}
+
 OptionsParametersComponent::OptionsParametersComponent(
     OptionsParameters* optionsParams)
     : _optionsParamsPtr(optionsParams),
       pitchStandardSlider("Tunes", "", _optionsParamsPtr->PitchStandard, this),
-      pitchBendRangeSlider("PB Range", "", _optionsParamsPtr->PitchBendRange, this) {
+      pitchBendRangeSlider("PB Range", "", _optionsParamsPtr->PitchBendRange, this),
+      macroClockSelector("Clock", _optionsParamsPtr->MacroClock, this) {
   addAndMakeVisible(pitchStandardSlider);
   addAndMakeVisible(pitchBendRangeSlider);
+  addAndMakeVisible(macroClockSelector);
 }
 
 void OptionsParametersComponent::paint(Graphics& g) {
@@ -405,7 +431,7 @@ void OptionsParametersComponent::paint(Graphics& g) {
 }
 
 void OptionsParametersComponent::resized() {
-  float columnSize = 2.0f;
+  float columnSize = 3.0f;
   float divide = 1.0f / columnSize;
   std::int32_t compHeight =
       std::int32_t((getHeight() - HEADER_HEIGHT) * divide);
@@ -415,11 +441,13 @@ void OptionsParametersComponent::resized() {
 
   pitchStandardSlider.setBounds(bounds.removeFromTop(compHeight));
   pitchBendRangeSlider.setBounds(bounds.removeFromTop(compHeight));
+  macroClockSelector.setBounds(bounds.removeFromTop(compHeight));
 }
 
 void OptionsParametersComponent::timerCallback() {
   pitchStandardSlider.setValue(_optionsParamsPtr->PitchStandard->get());
   pitchBendRangeSlider.setValue(_optionsParamsPtr->PitchBendRange->get());
+  macroClockSelector.setSelectedItemIndex(_optionsParamsPtr->MacroClock->getIndex());
 }
 
 void OptionsParametersComponent::sliderValueChanged(Slider* slider) {
@@ -432,6 +460,12 @@ void OptionsParametersComponent::sliderValueChanged(Slider* slider) {
   }
 }
 
+void OptionsParametersComponent::comboBoxChanged(ComboBox* comboBoxThatHasChanged) {
+  if (comboBoxThatHasChanged == &macroClockSelector.selector) {
+    *_optionsParamsPtr->MacroClock = macroClockSelector.getSelectedItemIndex();
+  }
+}
+
 MidiEchoParametersComponent::MidiEchoParametersComponent(
     MidiEchoParameters* midiEchoParams)
     : _midiEchoParamsPtr(midiEchoParams),
@@ -675,6 +709,135 @@ void FilterParametersComponent::buttonClicked(Button* button) {
   resized();
 }
 
+VoiceFilterParametersComponent::VoiceFilterParametersComponent(VoiceFilterParameters* voiceFilterParams)
+    : BaseComponent(),
+      _voiceFilterParamsPtr(voiceFilterParams),
+      enableSwitch("On", _voiceFilterParamsPtr->FilterEnable, this),
+      filterTypeSelector("Type", _voiceFilterParamsPtr->FilterType, this),
+      cutoffSlider("Cutoff", "Hz", _voiceFilterParamsPtr->Cutoff, this, 0.1f, 1000.0f),
+      resonanceSlider("Reso", "", _voiceFilterParamsPtr->Resonance, this, 0.01f, 1.0f),
+      keyTrackSlider("KeyTrk", "", _voiceFilterParamsPtr->KeyTrack, this, 0.01f),
+      envAmountSlider("EnvAmt", "oct", _voiceFilterParamsPtr->EnvAmount, this, 0.01f),
+      attackSlider("Attack", "sec", _voiceFilterParamsPtr->Attack, this, MIN_DELTA, 1.0f),
+      decaySlider("Decay", "sec", _voiceFilterParamsPtr->Decay, this, MIN_DELTA, 1.0f),
+      sustainSlider("Sustain", "", _voiceFilterParamsPtr->Sustain, this, MIN_DELTA),
+      releaseSlider("Release", "sec", _voiceFilterParamsPtr->Release, this, MIN_DELTA, 1.0f) {
+  addAndMakeVisible(enableSwitch);
+  addAndMakeVisible(filterTypeSelector);
+  addAndMakeVisible(cutoffSlider);
+  addAndMakeVisible(resonanceSlider);
+  addAndMakeVisible(keyTrackSlider);
+  addAndMakeVisible(envAmountSlider);
+  addAndMakeVisible(attackSlider);
+  addAndMakeVisible(decaySlider);
+  addAndMakeVisible(sustainSlider);
+  addAndMakeVisible(releaseSlider);
+}
+
+void VoiceFilterParametersComponent::paint(Graphics& g) {
+  paintHeader(g, getLocalBounds(), "VOICE FILTER");
+}
+
+void VoiceFilterParametersComponent::resized() {
+  float rowSize = 5.0f;
+  float divide = 1.0f / rowSize;
+  std::int32_t compHeight =
+      std::int32_t((getHeight() - HEADER_HEIGHT) * divide);
+
+  Rectangle<int> bounds = getLocalBounds();  // コンポーネント基準の値
+  bounds.removeFromTop(HEADER_HEIGHT);
+
+  {
+    float alpha = isEditable() ? 1.0f : 0.4f;
+    filterTypeSelector.setAlpha(alpha);
+    cutoffSlider.setAlpha(alpha);
+    resonanceSlider.setAlpha(alpha);
+    keyTrackSlider.setAlpha(alpha);
+    envAmountSlider.setAlpha(alpha);
+    attackSlider.setAlpha(alpha);
+    decaySlider.setAlpha(alpha);
+    sustainSlider.setAlpha(alpha);
+    releaseSlider.setAlpha(alpha);
+  }
+
+  const auto width = bounds.getWidth() / 2.0f;
+  {
+    auto area = bounds.removeFromTop(compHeight);
+    enableSwitch.setBounds(area.removeFromLeft(width));
+    filterTypeSelector.setBounds(area);
+  }
+  {
+    auto area = bounds.removeFromTop(compHeight);
+    cutoffSlider.setBounds(area.removeFromLeft(width));
+    resonanceSlider.setBounds(area);
+  }
+  {
+    auto area = bounds.removeFromTop(compHeight);
+    keyTrackSlider.setBounds(area.removeFromLeft(width));
+    envAmountSlider.setBounds(area);
+  }
+  {
+    auto area = bounds.removeFromTop(compHeight);
+    attackSlider.setBounds(area.removeFromLeft(width));
+    decaySlider.setBounds(area);
+  }
+  {
+    auto area = bounds.removeFromTop(compHeight);
+    sustainSlider.setBounds(area.removeFromLeft(width));
+    releaseSlider.setBounds(area);
+  }
+}
+
+void VoiceFilterParametersComponent::timerCallback() {
+  enableSwitch.setToggleState(_voiceFilterParamsPtr->FilterEnable->get());
+  filterTypeSelector.setSelectedItemIndex(_voiceFilterParamsPtr->FilterType->getIndex());
+  cutoffSlider.setValue(_voiceFilterParamsPtr->Cutoff->get());
+  resonanceSlider.setValue(_voiceFilterParamsPtr->Resonance->get());
+  keyTrackSlider.setValue(_voiceFilterParamsPtr->KeyTrack->get());
+  envAmountSlider.setValue(_voiceFilterParamsPtr->EnvAmount->get());
+  attackSlider.setValue(_voiceFilterParamsPtr->Attack->get());
+  decaySlider.setValue(_voiceFilterParamsPtr->Decay->get());
+  sustainSlider.setValue(_voiceFilterParamsPtr->Sustain->get());
+  releaseSlider.setValue(_voiceFilterParamsPtr->Release->get());
+}
+
+void VoiceFilterParametersComponent::sliderValueChanged(Slider* slider) {
+  if (slider == &cutoffSlider.slider) {
+    *_voiceFilterParamsPtr->Cutoff = (float)cutoffSlider.getValue();
+  } else if (slider == &resonanceSlider.slider) {
+    *_voiceFilterParamsPtr->Resonance = (float)resonanceSlider.getValue();
+  } else if (slider == &keyTrackSlider.slider) {
+    *_voiceFilterParamsPtr->KeyTrack = (float)keyTrackSlider.getValue();
+  } else if (slider == &envAmountSlider.slider) {
+    *_voiceFilterParamsPtr->EnvAmount = (float)envAmountSlider.getValue();
+  } else if (slider == &attackSlider.slider) {
+    *_voiceFilterParamsPtr->Attack = (float)attackSlider.getValue();
+  } else if (slider == &decaySlider.slider) {
+    *_voiceFilterParamsPtr->Decay = (float)decaySlider.getValue();
+  } else if (slider == &sustainSlider.slider) {
+    *_voiceFilterParamsPtr->Sustain = (float)sustainSlider.getValue();
+  } else if (slider == &releaseSlider.slider) {
+    *_voiceFilterParamsPtr->Release = (float)releaseSlider.getValue();
+  }
+}
+
+void VoiceFilterParametersComponent::buttonClicked(Button* button) {
+  if (button == &enableSwitch.button) {
+    *_voiceFilterParamsPtr->FilterEnable = enableSwitch.getToggleState();
+  }
+  resized();
+}
+
+void VoiceFilterParametersComponent::comboBoxChanged(ComboBox* comboBoxThatHasChanged) {
+  if (comboBoxThatHasChanged == &filterTypeSelector.selector) {
+    *_voiceFilterParamsPtr->FilterType = filterTypeSelector.getSelectedItemIndex();
+  }
+}
+
+bool VoiceFilterParametersComponent::isEditable() {
+  return _voiceFilterParamsPtr->FilterEnable->get();
+}
+
 WavePatternsComponent::WavePatternsComponent(WavePatternParameters* wavePatternParameters)
     : BaseComponent(), 
       _wavePatternParameters(wavePatternParameters),
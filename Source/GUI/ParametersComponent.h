@@ -91,6 +91,7 @@ class VibratoParametersComponent : public BaseComponent,
 
 class VoicingParametersComponent : public BaseComponent,
                                    ComboBox::Listener,
+                                   Button::Listener,
                                    Slider::Listener {
  public:
   VoicingParametersComponent(VoicingParameters* voicingParams);
@@ -104,14 +105,20 @@ class VoicingParametersComponent : public BaseComponent,
   virtual void timerCallback() override;
   virtual void sliderValueChanged(Slider* slider) override;
   virtual void comboBoxChanged(ComboBox* comboBoxThatHasChanged) override;
+  virtual void buttonClicked(Button* button) override;
 
   VoicingParameters* _voicingParamsPtr;
 
   TextSelector voicingTypeSelector;
+  TextSelector glideModeSelector;
   TextSlider stepTimeSlider;
+  SwitchButton legatoSwitch;
+  TextSelector notePrioritySelector;
 };
 
-class OptionsParametersComponent : public BaseComponent, Slider::Listener {
+class OptionsParametersComponent : public BaseComponent,
+                                   ComboBox::Listener,
+                                   Slider::Listener {
  public:
   OptionsParametersComponent(OptionsParameters* optionsParams);
 
@@ -123,11 +130,13 @@ class OptionsParametersComponent : public BaseComponent, Slider::Listener {
 
   virtual void timerCallback() override;
   virtual void sliderValueChanged(Slider* slider) override;
+  virtual void comboBoxChanged(ComboBox* comboBoxThatHasChanged) override;
 
   OptionsParameters* _optionsParamsPtr;
 
   TextSliderIncDec pitchStandardSlider;
   TextSliderIncDec pitchBendRangeSlider;
+  TextSelector macroClockSelector;
 };
 
 class MidiEchoParametersComponent : public BaseComponent,
@@ -224,6 +233,39 @@ class FilterParametersComponent : public BaseComponent,
   TextSlider lowcutFreqSlider;
 };
 
+class VoiceFilterParametersComponent : public BaseComponent,
+                                      Button::Listener,
+                                      ComboBox::Listener,
+                                      Slider::Listener {
+ public:
+  VoiceFilterParametersComponent(VoiceFilterParameters* voiceFilterParams);
+
+  virtual void paint(Graphics& g) override;
+  virtual void resized() override;
+
+ private:
+  VoiceFilterParametersComponent();
+
+  virtual void timerCallback() override;
+  virtual void sliderValueChanged(Slider* slider) override;
+  virtual void buttonClicked(Button* button) override;
+  virtual void comboBoxChanged(ComboBox* comboBoxThatHasChanged) override;
+  bool isEditable();
+
+  VoiceFilterParameters* _voiceFilterParamsPtr;
+
+  SwitchButton enableSwitch;
+  TextSelector filterTypeSelector;
+  TextSlider cutoffSlider;
+  TextSlider resonanceSlider;
+  TextSlider keyTrackSlider;
+  TextSlider envAmountSlider;
+  TextSlider attackSlider;
+  TextSlider decaySlider;
+  TextSlider sustainSlider;
+  TextSlider releaseSlider;
+};
+
 class WavePatternsComponent : public BaseComponent,
                               public Button::Listener,
                               public Slider::Listener,
@@ -246,12 +288,4 @@ class WavePatternsComponent : public BaseComponent,
   TextSlider _stepTimeSlider;
   TextSelector _waveTypeSelectors[4];
   PatternSliders _rangeSliders;
-
-  const StringArray OSC_WAVE_TYPES {
-  "NES_Square50%",    "NES_Square25%",   "NES_Square12.5%",
-  "NES_Triangle",     "Pure_Square50%",  "Pure_Square25%",
-  "Pure_Square12.5%", "Pure_Triangle",   "Pure_Sine",
-  "Pure_Saw",         "NES_LongNoise",   "NES_ShortNoise",
-  "Pure_Lo-bitNoise", "Waveform Memory",
-};
 };
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "../DSP/StageProfiler.h"
+
+// processBlockの区間ごとの処理時間を一覧表示するオーバーレイ. SANA_ENABLE_PROFILERが1のときだけ使う
+class ProfilerComponent : public Component, private juce::Timer {
+ public:
+  ProfilerComponent(StageProfiler& profiler) : _profiler(profiler) {
+    setInterceptsMouseClicks(false, false);
+  }
+
+  void visibilityChanged() override {
+    // 表示中だけ統計を回収する
+    if (isVisible()) {
+      startTimerHz(10);
+    } else {
+      stopTimer();
+    }
+  }
+
+  void paint(Graphics& g) override {
+    g.fillAll(Colours::black.withAlpha(0.8f));
+    g.setColour(Colours::orange);
+    g.drawRect(getLocalBounds(), 2);
+
+    auto bounds = getLocalBounds().reduced(8);
+    g.setFont(Font(Font::getDefaultMonospacedFontName(), 14.0f, Font::plain));
+    const auto rowHeight = 18;
+
+    const auto& stats = _profiler.getStats();
+
+    g.setColour(Colours::orange);
+    g.drawText(String::formatted("PROFILER  blocks: %d  load avg: %.1f%%  max: %.1f%%",
+                                 stats.numBlocks, stats.avgLoadPercent, stats.maxLoadPercent),
+               bounds.removeFromTop(rowHeight), Justification::centredLeft, false);
+
+    g.setColour(Colours::white);
+    g.drawText(String::formatted("%-18s %9s %9s %9s %9s", "stage [us]", "min", "avg", "p99", "max"),
+               bounds.removeFromTop(rowHeight), Justification::centredLeft, false);
+
+    for (auto i = 0; i < StageProfiler::NUM_STAGES; ++i) {
+      const auto stage = (StageProfiler::Stage)i;
+      const auto& s = stats.stages[(size_t)i];
+      g.drawText(String::formatted("%-18s %9.1f %9.1f %9.1f %9.1f", StageProfiler::getStageName(stage),
+                                   s.minMicroseconds, s.avgMicroseconds, s.p99Microseconds, s.maxMicroseconds),
+                 bounds.removeFromTop(rowHeight), Justification::centredLeft, false);
+    }
+  }
+
+ private:
+  void timerCallback() override {
+    _profiler.collect();
+    repaint();
+  }
+
+  StageProfiler& _profiler;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProfilerComponent)
+};
@@ -50,62 +50,74 @@ class AudioBufferQueue {
   void push(const SampleType* dataToPush, size_t numSamples) {
     // DBG("PUSH");
 
-    jassert(numSamples <= bufferSize);
+    // コンテナ1つ分より多いサンプルは, 複数のコンテナに分けて書き込む
+    while (numSamples > 0) {
+      const auto numToPush = jmin(bufferSize, numSamples);
+      pushSingle(dataToPush, numToPush);
+      dataToPush += numToPush;
+      numSamples -= numToPush;
+    }
+  }
+
+  void pop(SampleType* outputBuffer) {
+    // DBG("POP");
 
     int start1, size1, start2, size2;
 
-    // オーディオバッファーのコンテナ実体から書き込むべきコンテナのインデックスを特定する
-    // 第一引数:コンテナを何個分書き込みたいか
+    // オーディオバッファーのコンテナ実体から取り出すべきコンテナのインデックスを特定する
+    // 第一引数:コンテナを何個分まで読みたいか
     // 第二引数:コンテナのインデックス値を受け取る
     // 第三引数:読み込むコンテナの数を受け取る
     // 第四引数:0が入る
     // 第五引数:余りのコンテナ
-    abstractFifo.prepareToWrite(1, start1, size1, start2, size2);
+    abstractFifo.prepareToRead(1, start1, size1, start2, size2);
 
     jassert(size1 <= 1);
     jassert(size2 == 0);
 
     if (size1 > 0) {
-      // ベクターコンテナをコピーする。オーディオバッファー入力をキューに保持する。
+      // ベクターコンテナをコピーする。キューに保持されたバッファーデータを描画用のバッファにコピーする。
       // 内部ではmemcpy関数が実行される
-      FloatVectorOperations::copy(buffers[(size_t)start1].data(), dataToPush,
-                                  (int)jmin(bufferSize, numSamples));
+      FloatVectorOperations::copy(outputBuffer, buffers[(size_t)start1].data(),
+                                  (int)bufferSize);
     }
 
-    // 引数で渡された値だけ、最後尾のインデックスを移動する
+    // 引数で渡された値だけ、先頭のインデックスを移動する
     // 内部でインデックス値の循環が行われている
-    abstractFifo.finishedWrite(size1);
+    abstractFifo.finishedRead(size1);
   }
 
-  void pop(SampleType* outputBuffer) {
-    // DBG("POP");
+ private:
+  void pushSingle(const SampleType* dataToPush, size_t numSamples) {
+    jassert(numSamples <= bufferSize);
 
     int start1, size1, start2, size2;
 
-    // オーディオバッファーのコンテナ実体から取り出すべきコンテナのインデックスを特定する
-    // 第一引数:コンテナを何個分まで読みたいか
+    // オーディオバッファーのコンテナ実体から書き込むべきコンテナのインデックスを特定する
+    // 第一引数:コンテナを何個分書き込みたいか
     // 第二引数:コンテナのインデックス値を受け取る
     // 第三引数:読み込むコンテナの数を受け取る
     // 第四引数:0が入る
     // 第五引数:余りのコンテナ
-    abstractFifo.prepareToRead(1, start1, size1, start2, size2);
+    abstractFifo.prepareToWrite(1, start1, size1, start2, size2);
 
     jassert(size1 <= 1);
     jassert(size2 == 0);
 
     if (size1 > 0) {
-      // ベクターコンテナをコピーする。キューに保持されたバッファーデータを描画用のバッファにコピーする。
+      // ベクターコンテナをコピーする。オーディオバッファー入力をキューに保持する。
       // 内部ではmemcpy関数が実行される
-      FloatVectorOperations::copy(outputBuffer, buffers[(size_t)start1].data(),
-                                  (int)bufferSize);
+      auto& container = buffers[(size_t)start1];
+      FloatVectorOperations::copy(container.data(), dataToPush, (int)numSamples);
+      // 足りない分は無音で埋める
+      FloatVectorOperations::clear(container.data() + numSamples, (int)(bufferSize - numSamples));
     }
 
-    // 引数で渡された値だけ、先頭のインデックスを移動する
+    // 引数で渡された値だけ、最後尾のインデックスを移動する
     // 内部でインデックス値の循環が行われている
-    abstractFifo.finishedRead(size1);
+    abstractFifo.finishedWrite(size1);
   }
 
- private:
   // オーディオバッファー。サンプルデータを保持するコンテナをさらにコンテナ化したもの。
   std::array<std::array<SampleType, bufferSize>, numBuffers> buffers;
 
@@ -6,6 +6,8 @@
 
 namespace {
 const float MIN_DELTA = 0.0001f;
+// ホストのMIDIバッファとして最初に見込んでおくバイト数. 1イベント9バイトで900イベントほど
+const std::size_t HOST_MIDI_BUFFER_BYTES = 8192;
 }
 
 // This creates new instances of the plugin..
@@ -17,16 +19,16 @@ PluginProcessor ::PluginProcessor ()
     : BaseAudioProcessor(),
       presetsParameters(),
       chipOscParameters(
-        new AudioParameterChoice("OSC_WAVE_TYPE", "Osc-WaveType", OSC_WAVE_TYPES, 0),
+        new AudioParameterChoice("OSC_WAVE_TYPE", "Osc-WaveType", getChoiceNames(WAVE_TYPE_INFOS), 0),
         new AudioParameterFloat("VOLUME", "Volume", -32.0f, 8.0f, -20.0f),
         new AudioParameterFloat("AMPENV_ATTACK", "Attack", {0.000f, 10.0f, MIN_DELTA}, 0.000f),
         new AudioParameterFloat("AMPENV_DECAY", "Decay", {0.000f, 10.0f, MIN_DELTA}, 0.000f),
         new AudioParameterFloat("AMPENV_SUSTAIN", "Sustain", {0.000f, 1.0f, MIN_DELTA}, 1.0f),
         new AudioParameterFloat("AMPENV_RELEASE", "Release",  {0.000f, 10.0f, MIN_DELTA}, 0.000f),
-        new AudioParameterChoice("OSC_COLOR_TYPE", "Osc-ColorType", OSC_COLOR_TYPES, 0),
+        new AudioParameterChoice("OSC_COLOR_TYPE", "Osc-ColorType", getChoiceNames(COLOR_TYPE_INFOS), 0),
         new AudioParameterFloat("COLOR_DURATION", "Color-Duration", {0.001f, 0.5f, MIN_DELTA}, 0.1f)),
       sweepParameters(
-        new AudioParameterChoice("SWEEP_SWITCH", "Sweep-Switch", SWEEP_SWITCH, 0),
+        new AudioParameterChoice("SWEEP_SWITCH", "Sweep-Switch", getChoiceNames(SWEEP_TYPE_INFOS), 0),
         new AudioParameterFloat("SWEEP_TIME", "Sweep-Time", 0.01f, 10.0f, 1.0f)),
       vibratoParameters(
         new AudioParameterBool("VIBRATO_ENABLE", "Vibrato-Enable", false),
@@ -35,11 +37,16 @@ PluginProcessor ::PluginProcessor ()
         new AudioParameterFloat("VIBRATO_SPEED", "Vibrato-Speed", {0.0f, 20.0f, MIN_DELTA}, 4.f),
         new AudioParameterFloat("VIBRATO_ATTACKTIME", "Vibrato-AttackTime", {0.0f, 15.0f, MIN_DELTA}, 0.0f)),
       voicingParameters(
-        new AudioParameterChoice("VOICING_TYPE", "Voicing-Type", VOICING_SWITCH, 0),
-        new AudioParameterFloat("STEP_TIME", "Step-Time", {0.0f, 3.0f, MIN_DELTA}, 0.5f)),
+        new AudioParameterChoice("VOICING_TYPE", "Voicing-Type", getChoiceNames(VOICING_TYPE_INFOS), 0),
+        new AudioParameterFloat("STEP_TIME", "Step-Time", {0.0f, 3.0f, MIN_DELTA}, 0.5f),
+        new AudioParameterChoice("GLIDE_MODE", "Glide-Mode", getChoiceNames(GLIDE_MODE_TYPE_INFOS), 0),
+        new AudioParameterBool("LEGATO", "Legato", false),
+        new AudioParameterChoice("NOTE_PRIORITY", "Note-Priority", getChoiceNames(NOTE_PRIORITY_TYPE_INFOS), 0)),
       optionsParameters(
         new AudioParameterInt("PITCH_BEND_RANGE", "Pitch-Bend-Range", 1, 13, 2),
-        new AudioParameterInt("PITCH_STANDARD", "Pitch-Standard", 400, 500, 440)),
+        new AudioParameterInt("PITCH_STANDARD", "Pitch-Standard", 400, 500, 440),
+        new AudioParameterChoice("MACRO_CLOCK", "Macro-Clock", getChoiceNames(MACRO_CLOCK_TYPE_INFOS),
+                                 (int)MACRO_CLOCK_TYPE::SAMPLE)),
       midiEchoParameters(
         new AudioParameterBool("ECHO_ENABLE", "Echo-Enable", false),
         new AudioParameterFloat("ECHO_DURATION", "Echo-Duration", {0.01f, 3.0f, MIN_DELTA}, 0.1f),
@@ -50,9 +57,23 @@ PluginProcessor ::PluginProcessor ()
         new AudioParameterBool("LOWCUT_ENABLE", "Filter-Lowcut-Enable", false),
         new AudioParameterFloat("FILTER_HICUT-FREQ", "Filter-Hicut-Freq", 40.0f, 20000.0f, 20000.0f),
         new AudioParameterFloat("FILTER_LOWCUT-FREQ", "Filter-Lowcut-Freq", 40.0f, 20000.0f, 40.0f)),
+      voiceFilterParameters(
+        new AudioParameterBool("VOICEFILTER_ENABLE", "VoiceFilter-Enable", false),
+        new AudioParameterChoice("VOICEFILTER_TYPE", "VoiceFilter-Type", getChoiceNames(VOICE_FILTER_TYPE_INFOS), 0),
+        new AudioParameterFloat("VOICEFILTER_CUTOFF", "VoiceFilter-Cutoff", {40.0f, 20000.0f, 0.0f, 0.25f}, 20000.0f),
+        new AudioParameterFloat("VOICEFILTER_RESONANCE", "VoiceFilter-Resonance", {0.1f, 10.0f, MIN_DELTA, 0.5f}, 0.707f),
+        new AudioParameterFloat("VOICEFILTER_KEYTRACK", "VoiceFilter-KeyTrack", {0.0f, 1.0f, MIN_DELTA}, 0.0f),
+        new AudioParameterFloat("VOICEFILTER_ENVAMOUNT", "VoiceFilter-EnvAmount", {-8.0f, 8.0f, MIN_DELTA}, 0.0f),
+        new AudioParameterFloat("VOICEFILTER_ATTACK", "VoiceFilter-Attack", {0.000f, 10.0f, MIN_DELTA}, 0.000f),
+        new AudioParameterFloat("VOICEFILTER_DECAY", "VoiceFilter-Decay", {0.000f, 10.0f, MIN_DELTA}, 0.000f),
+        new AudioParameterFloat("VOICEFILTER_SUSTAIN", "VoiceFilter-Sustain", {0.000f, 1.0f, MIN_DELTA}, 1.0f),
+        new AudioParameterFloat("VOICEFILTER_RELEASE", "VoiceFilter-Release", {0.000f, 10.0f, MIN_DELTA}, 0.000f)),
       waveformMemoryParameters(),
       wavePatternParameters(),
-      scopeDataCollector(scopeDataQueue) {
+      colorSequenceParameters(),
+      synth(&voicingParameters),
+      scopeDataCollector(scopeDataQueue),
+      keyboardBridge(keyboardState, midiEventQueue) {
   presetsParameters.addAllParameters(*this);
   chipOscParameters.addAllParameters(*this);
   sweepParameters.addAllParameters(*this);
@@ -63,9 +84,20 @@ PluginProcessor ::PluginProcessor ()
   waveformMemoryParameters.addAllParameters(*this);
   filterParameters.addAllParameters(*this);
   wavePatternParameters.addAllParameters(*this);
+  voiceFilterParameters.addAllParameters(*this);
+  colorSequenceParameters.addAllParameters(*this);
+
+  // 後から既存のグループに加えたパラメータ. ホスト(特にVST2)はパラメータを登録順の番号で覚えるため,
+  // 保存済みのオートメーションがずれないよう, すべてのグループの後に追加した順で登録する
+  addParameter(optionsParameters.MacroClock);
+  addParameter(voicingParameters.GlideMode);
+  addParameter(voicingParameters.Legato);
+  addParameter(voicingParameters.NotePriority);
+
+  startTimerHz(10);
 }
 
-PluginProcessor ::~PluginProcessor () {}
+PluginProcessor ::~PluginProcessor () { stopTimer(); }
 
 int PluginProcessor::getNumPrograms() { return NUM_OF_PRESETS; }
 
@@ -177,81 +209,202 @@ const String PluginProcessor::getProgramName(int index) {
   }
 }
 
+// ホストは再生の停止やバウンスのたびに呼ぶため, 変わったものだけを準備し直す.
+// 内部処理はサブブロック単位なので, ホストのブロックサイズが変わっても作り直すものはない
 void PluginProcessor::prepareToPlay(double sampleRate, int32_t samplesPerBlock) {
-  synth.clearSounds();
-  synth.clearVoices();
+  const auto numChannels = jmax(getTotalNumOutputChannels(), 1);
+  const auto isSampleRateChanged = (sampleRate != preparedSampleRate);
+  const auto isNumChannelsChanged = (numChannels != preparedNumChannels);
+
+  // ボイスのサンプルレートは追加時にシンセから引き継がれるため, ボイスより先に設定する.
+  // 変わっていなければ何もしないので, 鳴っているノートもそのまま残る
   synth.setCurrentPlaybackSampleRate(sampleRate * UP_SAMPLING_FACTOR);
 
-  // サウンド再生可能なノート番号の範囲を定義する。関数"setRange"
-  // にて0～127の値をtrueに設定する。
-  BigInteger canPlayNotes;
-  canPlayNotes.setRange(0, 127, true);
-  // サウンド再生可能なチャンネル番号の範囲を定義する。関数"setRange"
-  // にて0～127の値をtrueに設定する。
-  BigInteger canPlayChannels;
-  canPlayChannels.setRange(1, 2, true);
-  synth.addSound(new SimpleSound(canPlayNotes, canPlayChannels));
-
-  for (auto i = 0, voiceNum = getNumVoices(); i < voiceNum; ++i) {
-    addVoice();
+  // サウンドとボイスは最初の呼び出しで1度だけ作る
+  if (synth.getNumSounds() == 0) {
+    // MIDIイベントの位置で必ずレンダリングを区切る. イベントの時刻はUP_SAMPLING_FACTORの倍数なので,
+    // 発音開始がホストの指定したサンプルから前後にずれることはない
+    synth.setMinimumSubBlockSize(UP_SAMPLING_FACTOR);
+
+    // サウンド再生可能なノート番号の範囲を定義する。関数"setRange"
+    // にて0～127の値をtrueに設定する。
+    BigInteger canPlayNotes;
+    canPlayNotes.setRange(0, 127, true);
+    // サウンド再生可能なチャンネル番号の範囲を定義する。関数"setRange"
+    // にて0～127の値をtrueに設定する。
+    BigInteger canPlayChannels;
+    canPlayChannels.setRange(1, 2, true);
+    synth.addSound(new SimpleSound(canPlayNotes, canPlayChannels));
   }
 
-  dsp::ProcessSpec spec = dsp::ProcessSpec();
-  spec.sampleRate = sampleRate;
-  spec.numChannels = getTotalNumOutputChannels();
-  spec.maximumBlockSize = samplesPerBlock;
-  initEffecters(spec);
+  {
+    const ScopedLock sl(echoBufferLock);
+    // ボイシングによらず最大数のボイスを用意し, 使うボイスの数はprocessBlockで切り替える
+    while (synth.getNumVoices() < VOICE_MAX) {
+      addVoice();
+    }
+
+    // エコーのバッファは今の長さと回数の分だけ確保する. 大きくなったときはtimerCallbackで確保し直す
+    for (auto* voice : voices) {
+      voice->prepareEchoBuffer(midiEchoParameters.EchoDuration->get(), midiEchoParameters.EchoRepeat->get());
+    }
+  }
 
-  antiAliasFilter.prepare((int32_t)sampleRate, UP_SAMPLING_FACTOR);
+  if (isSampleRateChanged || isNumChannelsChanged) {
+    dsp::ProcessSpec spec = dsp::ProcessSpec();
+    spec.sampleRate = sampleRate;
+    spec.numChannels = getTotalNumOutputChannels();
+    spec.maximumBlockSize = samplesPerBlock;
+    initEffecters(spec);
+  }
+
+  if (isSampleRateChanged) {
+    antiAliasFilter.prepare((int32_t)sampleRate, UP_SAMPLING_FACTOR);
+    voiceFilterBank.prepare(sampleRate * UP_SAMPLING_FACTOR, SUB_BLOCK_SIZE * UP_SAMPLING_FACTOR);
+  }
+
+  // 内部処理はサブブロック単位なので, 作業用のバッファもサブブロック1つ分だけ確保すればよい.
+  // 容量が足りていれば確保し直さない
+  if (isNumChannelsChanged) {
+    upSampleBuffer.setSize(numChannels, SUB_BLOCK_SIZE * UP_SAMPLING_FACTOR, false, false, true);
+  }
+  // サブブロックのイベントはホストのバッファと取り出したイベントの一部なので, 両方の合計を超えない
+  subBlockMidiMessages.ensureSize(HOST_MIDI_BUFFER_BYTES + MidiEventQueue::MIDI_BUFFER_BYTES);
+  injectedMidiMessages.ensureSize(MidiEventQueue::MIDI_BUFFER_BYTES);
+
+  preparedSampleRate = sampleRate;
+  preparedNumChannels = numChannels;
 }
 
 void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) {
-  // 高サンプルのバッファを用意しておく  
-  AudioBuffer<float> upSampleBuffer(buffer.getNumChannels(), buffer.getNumSamples() * UP_SAMPLING_FACTOR);
-  clearBuffers(buffer, upSampleBuffer);
+  // フィルタの減衰で非正規化数が発生すると極端に遅くなるため, 0に丸める
+  ScopedNoDenormals noDenormals;
 
-  // MIDIキーボードUI情報の更新
-  keyboardState.processNextMidiBuffer(midiMessages, 0, buffer.getNumSamples(),true);
+  SANA_PROFILE_BEGIN_BLOCK(stageProfiler);
+  {
+    SANA_PROFILE_STAGE(stageProfiler, StageProfiler::Stage::TOTAL);
+    SANA_TRACE_SCOPE(&traceRecorder, "processBlock", TraceRecorder::PROCESSOR_TRACK);
+    processBlockInternal(buffer, midiMessages);
+  }
+  SANA_PROFILE_END_BLOCK(stageProfiler, buffer.getNumSamples(), getSampleRate());
+}
+
+void PluginProcessor::processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& midiMessages) {
+  const auto numSamples = buffer.getNumSamples();
+  clearBuffers(buffer);
+
+  synth.setNumActiveVoices(getNumActiveVoices());
+
+  {
+    SANA_PROFILE_STAGE(stageProfiler, StageProfiler::Stage::MIDI);
+
+    // GUIなどから届いたMIDIイベントを取り出す. ホストのバッファはコピーせずサブブロックごとに合わせて読む
+    injectedMidiMessages.clear();
+    midiEventQueue.popAllInto(injectedMidiMessages, numSamples);
 
-  if (getNumVoices() != synth.getNumVoices()) {
-    changeVoiceSize();
+    // MIDIキーボードUI情報の更新. GUIの鍵盤へはロックを取らずにノートの状態だけを公開する
+    keyboardBridge.processMidiBuffer(midiMessages);
+    keyboardBridge.processMidiBuffer(injectedMidiMessages);
   }
 
-  procMidiMessages(buffer, midiMessages);
+  // ホストのバッファがこれまでより大きいときだけ確保し直す. 通常はprepareToPlayで確保した分に収まる
+  subBlockMidiMessages.ensureSize((size_t)(midiMessages.data.size() + injectedMidiMessages.data.size()));
 
-  // 波形生成
-  synth.renderNextBlock(upSampleBuffer, midiMessages, 0, upSampleBuffer.getNumSamples());
+  // テンポはホストのブロックごとに1回だけ読み込む
+  if (auto* playHead = getPlayHead()) {
+    AudioPlayHead::CurrentPositionInfo position;
+    if (playHead->getCurrentPosition(position) && position.bpm > 0.0) {
+      optionsParameters.currentBPM = (float)position.bpm;
+    }
+  }
 
-  // アンチエイリアス
-  antiAliasFilter.process(buffer, upSampleBuffer, getTotalNumInputChannels(), getTotalNumOutputChannels());
+  // このブロックで使うパラメータの値をトレースに残す
+  SANA_TRACE_COUNTER(&traceRecorder, "Volume", chipOscParameters.VolumeLevel->get());
+  SANA_TRACE_COUNTER(&traceRecorder, "HicutFreq", filterParameters.HicutFreq->get());
+  SANA_TRACE_COUNTER(&traceRecorder, "LowcutFreq", filterParameters.LowcutFreq->get());
+  SANA_TRACE_COUNTER(&traceRecorder, "VoiceFilterCutoff", voiceFilterParameters.Cutoff->get());
+  SANA_TRACE_COUNTER(&traceRecorder, "BlockSize", (float)numSamples);
+
+  // ホストのブロックサイズに関わらず, SUB_BLOCK_SIZEごとに区切って処理する
+  for (auto startSample = 0; startSample < numSamples; startSample += SUB_BLOCK_SIZE) {
+    const auto subBlockSize = jmin(SUB_BLOCK_SIZE, numSamples - startSample);
+    processSubBlock(buffer, midiMessages, startSample, subBlockSize);
+  }
+}
+
+void PluginProcessor::processSubBlock(AudioBuffer<float>& buffer, const MidiBuffer& midiMessages,
+                                      std::int32_t startSample, std::int32_t numSamples) {
+  const auto upSampleSize = numSamples * UP_SAMPLING_FACTOR;
+  upSampleBuffer.clear(0, upSampleSize);
+
+  // パラメータはサブブロックごとに読み込む. 反映される間隔がホストのブロックサイズによらず一定になる
+  voiceFilterBank.setParameters(
+      voiceFilterParameters.FilterEnable->get(),
+      toChipType<VOICE_FILTER_TYPE>(voiceFilterParameters.FilterType),
+      voiceFilterParameters.Cutoff->get(),
+      voiceFilterParameters.Resonance->get());
+  postEffectChain.setParameters(
+      chipOscParameters.VolumeLevel->get(),
+      filterParameters.HicutEnable->get(), filterParameters.HicutFreq->get(),
+      filterParameters.LowcutEnable->get(), filterParameters.LowcutFreq->get());
+  colorTableBank.updateUserSequence(colorSequenceParameters);
+  voiceParameterSnapshot.update(chipOscParameters, sweepParameters, vibratoParameters, optionsParameters,
+                                midiEchoParameters, wavePatternParameters, voiceFilterParameters, colorTableBank,
+                                (float)(getSampleRate() * UP_SAMPLING_FACTOR));
+
+  // このサブブロックに含まれるMIDIイベントを, サブブロック先頭を0とした内部サンプルレートの時刻で取り出す
+  {
+    SANA_PROFILE_STAGE(stageProfiler, StageProfiler::Stage::MIDI);
+    subBlockMidiMessages.clear();
+    addSubBlockMidiEvents(midiMessages, startSample, numSamples);
+    addSubBlockMidiEvents(injectedMidiMessages, startSample, numSamples);
+  }
+
+  // ボイスフィルタの準備. ボイスはフィルタが有効な間フィルタのレーンへ書き込む
+  if (voiceFilterBank.isEnabled()) {
+    voiceFilterBank.beginBlock(upSampleSize);
+  }
 
-  // エフェクトセクション
-  dsp::AudioBlock<float> audioBlock(buffer);
-  dsp::ProcessContextReplacing<float> context(audioBlock);
+  // 波形生成
+  {
+    SANA_PROFILE_STAGE(stageProfiler, StageProfiler::Stage::VOICES);
+    synth.renderBlock(upSampleBuffer, subBlockMidiMessages, 0, upSampleSize);
+  }
 
-  // ゲインを上げる
-  drive.setGainDecibels(chipOscParameters.VolumeLevel->get());
-  drive.process(context);
+  // ボイスフィルタ処理, 全ボイスの出力をまとめてバッファに加算する
+  if (voiceFilterBank.isEnabled()) {
+    SANA_PROFILE_STAGE(stageProfiler, StageProfiler::Stage::VOICE_FILTER);
+    voiceFilterBank.process(upSampleBuffer, 0, upSampleSize);
+  }
 
-  // フィルタ処理
+  // アンチエイリアス
   {
-    if (filterParameters.HicutEnable->get()) {
-      *hicutFilter.state = *dsp::IIR::Coefficients<float>::makeLowPass(
-          getSampleRate(), filterParameters.HicutFreq->get());
-      hicutFilter.process(context);
-    }
-    if (filterParameters.LowcutEnable->get()) {
-      *lowcutFilter.state = *dsp::IIR::Coefficients<float>::makeHighPass(
-          getSampleRate(), filterParameters.LowcutFreq->get());
-      lowcutFilter.process(context);
-    }
+    SANA_PROFILE_STAGE(stageProfiler, StageProfiler::Stage::DECIMATION);
+    antiAliasFilter.process(buffer, startSample, numSamples, upSampleBuffer,
+                            getTotalNumInputChannels(), getTotalNumOutputChannels());
   }
-  // クリッピング処理
-  clipper.process(context);
 
-  // ⑧現時点でオーディオバッファで保持しているサンプルデータをScopeDataCollectorクラスのオブジェクトに渡す。
-  scopeDataCollector.process(buffer.getReadPointer(0),
-                             (size_t)buffer.getNumSamples());
+  // エフェクトセクション. ドライブ → フィルタ → クリッピング → スコープへの受け渡しを
+  // まとめて行う
+  {
+    SANA_PROFILE_STAGE(stageProfiler, StageProfiler::Stage::EFFECTS);
+    postEffectChain.process(buffer, startSample, numSamples, [this](const float* data, std::int32_t size) {
+      SANA_PROFILE_STAGE(stageProfiler, StageProfiler::Stage::SCOPE_TAP);
+      scopeDataCollector.process(data, (size_t)size);
+    });
+  }
+}
+
+void PluginProcessor::addSubBlockMidiEvents(const MidiBuffer& source, std::int32_t startSample, std::int32_t numSamples) {
+  const auto endSample = startSample + numSamples;
+  for (auto it = source.findNextSamplePosition(startSample); it != source.cend(); ++it) {
+    const auto metadata = *it;
+    if (metadata.samplePosition >= endSample) {
+      break;
+    }
+    subBlockMidiMessages.addEvent(metadata.data, metadata.numBytes,
+                                  (metadata.samplePosition - startSample) * UP_SAMPLING_FACTOR);
+  }
 }
 
 AudioProcessorEditor* PluginProcessor::createEditor() {
@@ -276,6 +429,8 @@ void PluginProcessor::getStateInformation(MemoryBlock& destData) {
   waveformMemoryParameters.saveParameters(*xml);
   filterParameters.saveParameters(*xml);
   wavePatternParameters.saveParameters(*xml);
+  voiceFilterParameters.saveParameters(*xml);
+  colorSequenceParameters.saveParameters(*xml);
 
   copyXmlToBinary(*xml, destData);
 }
@@ -300,6 +455,8 @@ void PluginProcessor::setStateInformation(const void* data,
       waveformMemoryParameters.loadParameters(*xmlState);
       filterParameters.loadParameters(*xmlState);
       wavePatternParameters.loadParameters(*xmlState);
+      voiceFilterParameters.loadParameters(*xmlState);
+      colorSequenceParameters.loadParameters(*xmlState);
     }
 
     // Preset用のパラメータを更新（変数をローカルintで保存しないとシンセ終了時にフリーズする
@@ -324,8 +481,8 @@ void PluginProcessor::initProgram() {
   *vibratoParameters.VibratoAttackTime = 0.0f;
 }
 
-std::int32_t PluginProcessor::getNumVoices() {
-  if (voicingParameters.VoicingSwitch->getCurrentChoiceName() == "POLY") {
+std::int32_t PluginProcessor::getNumActiveVoices() {
+  if (toChipType<VOICING_TYPE>(voicingParameters.VoicingSwitch) == VOICING_TYPE::POLY) {
     return VOICE_MAX;
   } else {
     return 1;
@@ -333,81 +490,37 @@ std::int32_t PluginProcessor::getNumVoices() {
 }
 
 void PluginProcessor::addVoice() {
-  synth.addVoice(new SimpleVoice(&chipOscParameters, &sweepParameters,
-                                 &vibratoParameters, &voicingParameters,
-                                 &optionsParameters, &midiEchoParameters,
-                                 &waveformMemoryParameters, &wavePatternParameters));
+  auto* voice = new SimpleVoice(&chipOscParameters, &sweepParameters,
+                                &vibratoParameters, &voicingParameters,
+                                &optionsParameters, &midiEchoParameters,
+                                &waveformMemoryParameters, &wavePatternParameters,
+                                &voiceFilterParameters, &voiceFilterBank,
+                                &colorTableBank, &voiceParameterSnapshot, synth.getNumVoices());
+#if SANA_ENABLE_TRACE
+  voice->setTraceRecorder(&traceRecorder);
+#endif
+  synth.addVoice(voice);
+  voices.push_back(voice);
 }
 
-void PluginProcessor::changeVoiceSize() {
-  const auto voiceNum = getNumVoices();
-
-  while (synth.getNumVoices() != voiceNum) {
-    if (synth.getNumVoices() > voiceNum) {
-      synth.removeVoice(synth.getNumVoices() - 1);
-    } else {
-      addVoice();
-    }
-  }
-}
-
-void PluginProcessor::clearBuffers(AudioBuffer<float>& buffer, AudioBuffer<float>& upSampleBuffer) {
-  const auto totalNumInputChannels = getTotalNumInputChannels();
-  const auto totalNumOutputChannels = getTotalNumOutputChannels();
-  const auto totalChannel = totalNumInputChannels + totalNumInputChannels;
-  for (auto channel = 0; channel < totalChannel; ++channel) {
+void PluginProcessor::clearBuffers(AudioBuffer<float>& buffer) {
+  // 入力チャンネルのデータは使わないので消しておく. 出力チャンネルはアンチエイリアスで上書きされる
+  for (auto channel = 0, numChannels = jmin(getTotalNumInputChannels(), buffer.getNumChannels());
+       channel < numChannels; ++channel) {
     buffer.clear(channel, 0, buffer.getNumSamples());
   }
-
-  for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i) {
-    upSampleBuffer.clear(i, 0, upSampleBuffer.getNumSamples());
-  }
-}
-
-float PluginProcessor::clippingFunction(float inputValue) {
-  // 双曲線正接...1の時に0.8の値を, -1の時に-0.8の値を取る
-  const float threshold = tanhf(inputValue);
-  float outputValue = inputValue;
-
-  // inputValueが正の値ならthresholdも正の値，inputValueが負の値ならthresholdも負の値を取るので，絶対値で比較する
-  if (abs(inputValue) >= abs(threshold)) outputValue = threshold;
-
-  return outputValue;
 }
 
 void PluginProcessor::initEffecters(dsp::ProcessSpec& spec) {
-  drive.prepare(spec);
-
-  clipper.prepare(spec);
-  clipper.functionToUse = clippingFunction;
-
-  hicutFilter.prepare(spec);
-  lowcutFilter.prepare(spec);
+  postEffectChain.prepare(spec.sampleRate, (std::int32_t)spec.numChannels);
 }
 
-void PluginProcessor::procMidiMessages(const AudioBuffer<float>& buffer, const MidiBuffer& midiMessages) {
-  auto midibuffer = midiMessages;
-  auto startSample = 0;
-  auto numSamples = buffer.getNumSamples();
-
-  MidiBuffer::Iterator i(midibuffer);
-  MidiMessage message;
-  int time;
+void PluginProcessor::timerCallback() { updateEchoBuffers(); }
 
-  {
-    MidiBuffer::Iterator i2(eventsToAdd);
-    const auto firstEventToAdd = eventsToAdd.getFirstEventTime();
-    const auto scaleFactor =
-        numSamples /
-        (float)(eventsToAdd.getLastEventTime() + 1 - firstEventToAdd);
-
-    while (i2.getNextEvent(message, time)) {
-      const int pos =
-          jlimit(0, numSamples - 1,
-                  roundToInt((time - firstEventToAdd) * scaleFactor));
-      midibuffer.addEvent(message, startSample + pos);
-    }
+void PluginProcessor::updateEchoBuffers() {
+  // 確保したバッファはボイスがサブブロックの先頭で受け取る. 受け取るまでは短いエコーで鳴らす
+  const ScopedLock sl(echoBufferLock);
+  for (auto* voice : voices) {
+    voice->reserveEchoBuffer(midiEchoParameters.EchoDuration->get(), midiEchoParameters.EchoRepeat->get());
   }
-
-  eventsToAdd.clear();
-}
\ No newline at end of file
+}
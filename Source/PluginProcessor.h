@@ -2,11 +2,22 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "BaseAudioProcessor.h"
+#include "DSP/ChipSynthesiser.h"
+#include "DSP/ColorTable.h"
 #include "DSP/DspUtils.h"
+#include "DSP/EffectChain.h"
+#include "DSP/KeyboardStateBridge.h"
+#include "DSP/MidiEventQueue.h"
+#include "DSP/StageProfiler.h"
 #include "DSP/SynthParameters.h"
+#include "DSP/TraceRecorder.h"
+#include "DSP/VoiceFilter.h"
+#include "DSP/VoiceParameterSnapshot.h"
 #include "GUI/ScopeComponent.hpp"
 
-class PluginProcessor : public BaseAudioProcessor {
+class SimpleVoice;
+
+class PluginProcessor : public BaseAudioProcessor, private Timer {
  public:
   PluginProcessor ();
   ~PluginProcessor ();
@@ -26,10 +37,19 @@ class PluginProcessor : public BaseAudioProcessor {
   void setStateInformation(const void* data, int sizeInBytes) override;
   
   MidiKeyboardState& getKeyboardState() { return keyboardState; }
+  KeyboardStateBridge& getKeyboardBridge() { return keyboardBridge; }
+#if SANA_ENABLE_PROFILER
+  StageProfiler& getStageProfiler() { return stageProfiler; }
+#endif
+#if SANA_ENABLE_TRACE
+  TraceRecorder& getTraceRecorder() { return traceRecorder; }
+#endif
   AudioBufferQueue<float>& getAudioBufferQueue() { return scopeDataQueue; }
-
-  const StringArray SWEEP_SWITCH {"OFF", "Positive", "Negative"};
-  const StringArray VOICING_SWITCH {"POLY", "MONO", "PORTAMENTO"};
+  // オーディオスレッド以外からMIDIイベントを送るためのキュー. 書き込みはメッセージスレッドからのみ行う
+  MidiEventQueue& getMidiEventQueue() { return midiEventQueue; }
+  // エコーの長さや回数が大きくなっていれば, ボイスのエコーのバッファを確保し直す.
+  // オーディオスレッド以外から呼ぶ. 通常はタイマーから呼ばれる
+  void updateEchoBuffers();
 
   ChipOscillatorParameters chipOscParameters;
   SweepParameters sweepParameters;
@@ -39,20 +59,33 @@ class PluginProcessor : public BaseAudioProcessor {
   WaveformMemoryParameters waveformMemoryParameters;
   MidiEchoParameters midiEchoParameters;
   FilterParameters filterParameters;
+  VoiceFilterParameters voiceFilterParameters;
   PresetsParameters presetsParameters;
   WavePatternParameters wavePatternParameters;
+  ColorSequenceParameters colorSequenceParameters;
 
  private:
   void initProgram();
-  std::int32_t getNumVoices();
+  std::int32_t getNumActiveVoices();
   void addVoice();
-  void changeVoiceSize();
-  void clearBuffers(AudioBuffer<float>& buffer, AudioBuffer<float>& upSampleBuffer);
-  static float clippingFunction(float inputValue);
+  void processBlockInternal(AudioBuffer<float>& buffer, MidiBuffer& midiMessages);
+  void processSubBlock(AudioBuffer<float>& buffer, const MidiBuffer& midiMessages,
+                       std::int32_t startSample, std::int32_t numSamples);
+  void addSubBlockMidiEvents(const MidiBuffer& source, std::int32_t startSample, std::int32_t numSamples);
+  void clearBuffers(AudioBuffer<float>& buffer);
   void initEffecters(dsp::ProcessSpec& spec);
-  void procMidiMessages(const AudioBuffer<float>& buffer, const MidiBuffer& midiMessages);
+  void timerCallback() override;
+
+  // MONO / PORTAMENTOではボイスを検索せず, ノートの優先度に従って先頭のボイスで鳴らす
+  ChipSynthesiser synth;
+  // synthに追加したボイス. エコーのバッファを確保するときにシンセのロックを取らずに使う
+  std::vector<SimpleVoice*> voices;
+  // prepareToPlayとtimerCallbackが別スレッドから呼ばれた場合に, voicesとエコーのバッファを守る
+  CriticalSection echoBufferLock;
 
-  Synthesiser synth;
+  // 前回のprepareToPlayの設定. 変わったものだけを準備し直すために使う
+  double preparedSampleRate = 0.0;
+  std::int32_t preparedNumChannels = 0;
 
   // preset index
   std::int32_t currentProgIndex;
@@ -60,25 +93,47 @@ class PluginProcessor : public BaseAudioProcessor {
   //アンチエイリアスフィルタ用
   antiAliasFilter antiAliasFilter;
 
-  // DSPエフェクト，クリッパー，ドライブ，フィルタ
-  dsp::WaveShaper<float> clipper;
-  dsp::Gain<float> drive;
-  dsp::ProcessorDuplicator<dsp::IIR::Filter<float>,
-                           dsp::IIR::Coefficients<float>>
-      hicutFilter;
-  dsp::ProcessorDuplicator<dsp::IIR::Filter<float>,
-                           dsp::IIR::Coefficients<float>>
-      lowcutFilter;
+  // サブブロック1つ分の高サンプルのバッファと, そこに含まれるMIDIイベント.
+  // processBlock中に確保しないようprepareToPlayで用意しておく
+  AudioBuffer<float> upSampleBuffer;
+  MidiBuffer subBlockMidiMessages;
+
+  // ボイスごとのフィルタ. 全ボイス分をSIMDでまとめて処理する
+  VoiceFilterBank voiceFilterBank;
+
+  // 音色エンベロープの周波数比. USERのステップはサブブロックごとにパラメータと比べて作り直す
+  ColorTableBank colorTableBank;
+
+  // ボイスが使うパラメータ. サブブロックごとに1回だけ読み込み, 全ボイスで共有する
+  VoiceParameterSnapshot voiceParameterSnapshot;
+
+  // DSPエフェクト，ドライブ，フィルタ，クリッパーを1回の走査で処理する
+  PostEffectChain postEffectChain;
 
   // GUI上のキーボードコンポーネントで生成されたMIDI情報を保持しておくオブジェクト.
-  // MIDIキーボードの状態を同期するためのステートオブジェクト
+  // MIDIキーボードの状態を同期するためのステートオブジェクト. GUIスレッドからのみ触る
   MidiKeyboardState keyboardState;
 
   // スコープパネルに波形を表示するためのデータバッファ
   AudioBufferQueue<float> scopeDataQueue;
   ScopeDataCollector<float> scopeDataCollector;
 
-  MidiBuffer eventsToAdd;
+  // 他スレッドから送られたMIDIイベントと, それをブロックごとに取り出しておくバッファ
+  MidiEventQueue midiEventQueue;
+  MidiBuffer injectedMidiMessages;
+
+  // オーディオスレッドのノート状態をGUIの鍵盤へ反映し, 鍵盤の入力をmidiEventQueueへ送る
+  KeyboardStateBridge keyboardBridge;
+
+#if SANA_ENABLE_PROFILER
+  // processBlockの区間ごとの処理時間
+  StageProfiler stageProfiler;
+#endif
+
+#if SANA_ENABLE_TRACE
+  // オーディオスレッドのイベントをChromeのトレース形式で書き出す. GUIから記録を開始/停止する
+  TraceRecorder traceRecorder;
+#endif
   
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginProcessor )
 };
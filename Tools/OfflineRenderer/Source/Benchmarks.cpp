@@ -0,0 +1,672 @@
+#include "Benchmarks.h"
+
+#include <limits>
+
+#include "../../../Source/DSP/AmpEnvelope.h"
+#include "../../../Source/DSP/ChipSynthesiser.h"
+#include "../../../Source/DSP/ColorEnvelope.h"
+#include "../../../Source/DSP/MIDIEcho.h"
+#include "../../../Source/DSP/SimpleSound.h"
+#include "../../../Source/DSP/SimpleVoice.h"
+#include "../../../Source/DSP/SoftClipper.h"
+#include "../../../Source/DSP/Waveforms.h"
+#include "OfflineRenderer.h"
+
+namespace {
+const double TWO_PI = MathConstants<double>::twoPi;
+
+// 和音のノート番号. ボイス数に応じて先頭から使う
+const std::int32_t CHORD_NOTES[] = {48, 55, 60, 64, 67, 71, 74, 79};
+
+// 一定の周期でノートオンとノートオフを繰り返し, 発音開始/リリース/エコーの処理も計測に含める
+class NoteRetrigger {
+ public:
+  NoteRetrigger(double sampleRate, std::int32_t numNotes)
+      : period(jmax((std::int64_t)1, (std::int64_t)(sampleRate * 0.25))),
+        numNotes(jmin(numNotes, (std::int32_t)numElementsInArray(CHORD_NOTES))) {}
+
+  // numSamples分進め, その間に来るイベントをブロック先頭からの位置でmidiMessagesへ追加する
+  void fill(MidiBuffer& midiMessages, std::int32_t numSamples) {
+    for (auto i = 0; i < numSamples; ++i, ++position) {
+      const auto phase = position % period;
+      if (phase == 0) {
+        for (auto n = 0; n < numNotes; ++n) {
+          midiMessages.addEvent(MidiMessage::noteOn(1, CHORD_NOTES[n], (uint8)100), i);
+        }
+      } else if (phase == period * 3 / 4) {
+        for (auto n = 0; n < numNotes; ++n) {
+          midiMessages.addEvent(MidiMessage::noteOff(1, CHORD_NOTES[n]), i);
+        }
+      }
+    }
+  }
+
+ private:
+  std::int64_t position = 0;
+  std::int64_t period;
+  std::int32_t numNotes;
+};
+
+struct WaveformCase {
+  const char* name;
+  float (Waveforms::*function)(float);
+  // ノイズは位相ではなく位相の増分を受け取る
+  bool takesAngleDelta;
+};
+
+const WaveformCase WAVEFORM_CASES[] = {
+    {"nesTriangle", &Waveforms::nesTriangle, false},
+    {"nesSquare", &Waveforms::nesSquare, false},
+    {"nesSquare25", &Waveforms::nesSquare25, false},
+    {"nesSquare125", &Waveforms::nesSquare125, false},
+    {"sine", &Waveforms::sine, false},
+    {"roughSine", &Waveforms::roughSine, false},
+    {"saw", &Waveforms::saw, false},
+    {"roughSaw", &Waveforms::roughSaw, false},
+    {"square", &Waveforms::square, false},
+    {"square25", &Waveforms::square25, false},
+    {"square125", &Waveforms::square125, false},
+    {"triangle", &Waveforms::triangle, false},
+    {"longNoise", &Waveforms::longNoise, true},
+    {"shortNoise", &Waveforms::shortNoise, true},
+    {"noise", &Waveforms::noise, true},
+    {"lobitNoise", &Waveforms::lobitNoise, true},
+};
+}  // namespace
+
+String BenchmarkResult::getKey() const {
+  return name + "/" + String((int)sampleRate) + "/" + String(blockSize) + "/" + String(numVoices) + "/" +
+         features;
+}
+
+var BenchmarkResult::toVar() const {
+  DynamicObject::Ptr object(new DynamicObject());
+  object->setProperty("key", getKey());
+  object->setProperty("name", name);
+  object->setProperty("sampleRate", sampleRate);
+  object->setProperty("blockSize", blockSize);
+  object->setProperty("voices", numVoices);
+  object->setProperty("features", features);
+  object->setProperty("nsPerSample", nanosecondsPerSample);
+  object->setProperty("realtimeFactor", realtimeFactor);
+  return var(object.get());
+}
+
+BenchmarkSuite::BenchmarkSuite(const BenchmarkOptions& o) : options(o) {
+  if (options.quick) {
+    sampleRates = {48000.0};
+    blockSizes = {1, 64, 512};
+    voiceCounts = {1, VOICE_MAX};
+    featureSets = {0, FEATURE_ECHO | FEATURE_VOICE_FILTER | FEATURE_POST_FILTERS | FEATURE_MODULATION};
+  } else {
+    sampleRates = {44100.0, 48000.0, 96000.0, 192000.0};
+    blockSizes = {1, 32, 64, 256, 1024, 4096};
+    voiceCounts = {1, 4, VOICE_MAX};
+    featureSets = {0,
+                   FEATURE_ECHO,
+                   FEATURE_VOICE_FILTER,
+                   FEATURE_POST_FILTERS,
+                   FEATURE_MODULATION,
+                   FEATURE_ECHO | FEATURE_VOICE_FILTER | FEATURE_POST_FILTERS | FEATURE_MODULATION};
+  }
+}
+
+BenchmarkSuite::~BenchmarkSuite() {}
+
+void BenchmarkSuite::run(const ResultCallback& callback) {
+  ScopedNoDenormals noDenormals;
+
+  onResult = callback;
+  results.clear();
+  parameterOwner.reset(new PluginProcessor());
+
+  runWaveforms();
+  runEnvelopes();
+  runEchoBuffer();
+  runAntiAliasFilter();
+  runSoftClipper();
+  runVoice();
+  runProcessBlock();
+
+  parameterOwner.reset();
+}
+
+void BenchmarkSuite::runWaveforms() {
+  for (const auto& waveformCase : WAVEFORM_CASES) {
+    const auto name = String("Waveforms::") + waveformCase.name;
+    if (!shouldRun(name)) {
+      continue;
+    }
+
+    for (const auto sampleRate : sampleRates) {
+      const auto angleDelta = (float)(TWO_PI * 440.0 / (sampleRate * UP_SAMPLING_FACTOR));
+      for (const auto blockSize : blockSizes) {
+        Waveforms waveforms;
+        auto angle = 0.0f;
+        const auto nanoseconds = measure(
+            [&](std::int32_t numSamples) {
+              auto sum = 0.0f;
+              for (auto i = 0; i < numSamples * UP_SAMPLING_FACTOR; ++i) {
+                sum += (waveforms.*waveformCase.function)(waveformCase.takesAngleDelta ? angleDelta : angle);
+                angle += angleDelta;
+                if (angle > (float)TWO_PI) {
+                  angle -= (float)TWO_PI;
+                }
+              }
+              sink += sum;
+            },
+            blockSize);
+        addResult({name, sampleRate, blockSize, 1, "", nanoseconds});
+      }
+    }
+  }
+
+  const String memoryName = "Waveforms::waveformMemory";
+  if (shouldRun(memoryName)) {
+    for (const auto sampleRate : sampleRates) {
+      const auto angleDelta = (float)(TWO_PI * 440.0 / (sampleRate * UP_SAMPLING_FACTOR));
+      for (const auto blockSize : blockSizes) {
+        Waveforms waveforms;
+        auto angle = 0.0f;
+        const auto nanoseconds = measure(
+            [&](std::int32_t numSamples) {
+              auto sum = 0.0f;
+              for (auto i = 0; i < numSamples * UP_SAMPLING_FACTOR; ++i) {
+                sum += waveforms.waveformMemory(angle, &parameterOwner->waveformMemoryParameters);
+                angle += angleDelta;
+                if (angle > (float)TWO_PI) {
+                  angle -= (float)TWO_PI;
+                }
+              }
+              sink += sum;
+            },
+            blockSize);
+        addResult({memoryName, sampleRate, blockSize, 1, "", nanoseconds});
+      }
+    }
+  }
+}
+
+void BenchmarkSuite::runEnvelopes() {
+  auto& chipOscParameters = parameterOwner->chipOscParameters;
+
+  const String ampName = "AmpEnvelope::cycle";
+  if (shouldRun(ampName)) {
+    for (const auto sampleRate : sampleRates) {
+      const auto internalRate = sampleRate * UP_SAMPLING_FACTOR;
+      for (const auto blockSize : blockSizes) {
+        // 各ステージを通るように短めの時間を設定し, 一定周期で発音/リリースを繰り返す
+        AmpEnvelope envelope(0.01f, 0.05f, 0.5f, 0.05f, 0.0f);
+        envelope.setSampleRate((float)internalRate);
+        const auto period = (std::int64_t)(internalRate * 0.25);
+        std::int64_t position = 0;
+        const auto nanoseconds = measure(
+            [&](std::int32_t numSamples) {
+              auto sum = 0.0f;
+              for (auto i = 0; i < numSamples * UP_SAMPLING_FACTOR; ++i, ++position) {
+                const auto phase = position % period;
+                if (phase == 0) {
+                  envelope.attackStart();
+                } else if (phase == period / 2) {
+                  envelope.releaseStart();
+                }
+                envelope.cycle();
+                sum += envelope.getValue();
+              }
+              sink += sum;
+            },
+            blockSize);
+        addResult({ampName, sampleRate, blockSize, 1, "", nanoseconds});
+      }
+    }
+  }
+
+  const String ampBlockName = "AmpEnvelope::renderBlock";
+  if (shouldRun(ampBlockName)) {
+    for (const auto sampleRate : sampleRates) {
+      const auto internalRate = sampleRate * UP_SAMPLING_FACTOR;
+      for (const auto blockSize : blockSizes) {
+        // AmpEnvelope::cycleと同じ発音/リリースの周期で, ボイスと同じく128サンプル以下ずつ計算する
+        AmpEnvelope envelope(0.01f, 0.05f, 0.5f, 0.05f, 0.0f);
+        envelope.setSampleRate((float)internalRate);
+        const auto period = (std::int64_t)(internalRate * 0.25);
+        const std::int32_t chunkSize = SUB_BLOCK_SIZE * UP_SAMPLING_FACTOR;
+        std::vector<float> values((size_t)chunkSize);
+        std::int64_t position = 0;
+        const auto nanoseconds = measure(
+            [&](std::int32_t numSamples) {
+              auto sum = 0.0f;
+              auto remaining = numSamples * UP_SAMPLING_FACTOR;
+              while (remaining > 0) {
+                const auto phase = position % period;
+                if (phase == 0) {
+                  envelope.attackStart();
+                } else if (phase == period / 2) {
+                  envelope.releaseStart();
+                }
+                // 発音/リリースの位置で区切る
+                const auto untilEvent = phase < period / 2 ? period / 2 - phase : period - phase;
+                const auto n = (std::int32_t)jmin((std::int64_t)jmin(chunkSize, remaining), untilEvent);
+                envelope.renderBlock(values.data(), n);
+                for (auto i = 0; i < n; ++i) {
+                  sum += values[(size_t)i];
+                }
+                remaining -= n;
+                position += n;
+              }
+              sink += sum;
+            },
+            blockSize);
+        addResult({ampBlockName, sampleRate, blockSize, 1, "", nanoseconds});
+      }
+    }
+  }
+
+  const String colorName = "ColorEnvelope::cycle";
+  if (shouldRun(colorName)) {
+    // ステップの少ないもの, 多いもの, ループしないものを選ぶ
+    const COLOR_TYPE colorTypes[] = {COLOR_TYPE::NONE, COLOR_TYPE::ARP_MAJOR7TH, COLOR_TYPE::ORC_HIT3};
+    const ColorTableBank colorTableBank;
+    for (const auto colorType : colorTypes) {
+      *chipOscParameters.ColorType = (int)colorType;
+      for (const auto sampleRate : sampleRates) {
+        const auto internalRate = (float)(sampleRate * UP_SAMPLING_FACTOR);
+        for (const auto blockSize : blockSizes) {
+          ColorEnvelope envelope(&chipOscParameters, &colorTableBank);
+          envelope.clear();
+          const auto nanoseconds = measure(
+              [&](std::int32_t numSamples) {
+                auto sum = 0.0f;
+                envelope.beginBlock(internalRate);
+                for (auto i = 0; i < numSamples * UP_SAMPLING_FACTOR; ++i) {
+                  envelope.cycle();
+                  sum += envelope.getRatio();
+                }
+                sink += sum;
+              },
+              blockSize);
+          addResult({colorName, sampleRate, blockSize, 1, "color=" + String(getColorTypeInfo(colorType).name), nanoseconds});
+        }
+      }
+    }
+    *chipOscParameters.ColorType = 0;
+  }
+}
+
+void BenchmarkSuite::runEchoBuffer() {
+  const String name = "EchoBuffer";
+  if (!shouldRun(name)) {
+    return;
+  }
+
+  // SimpleVoiceと同じく1サンプルごとに書き込み, 全リピートを読み出して進める
+  for (const auto repeat : {1, 3, 5}) {
+    for (const auto sampleRate : sampleRates) {
+      const auto internalRate = (int)(sampleRate * UP_SAMPLING_FACTOR);
+      for (const auto blockSize : blockSizes) {
+        EchoBuffer echoBuffer(internalRate, 0.1f, repeat);
+        echoBuffer.prepare(0.1f, repeat);
+        auto value = 0.0f;
+        const auto nanoseconds = measure(
+            [&](std::int32_t numSamples) {
+              auto sum = 0.0f;
+              for (auto i = 0; i < numSamples * UP_SAMPLING_FACTOR; ++i) {
+                value = value > 0.5f ? -0.5f : value + 0.01f;
+                echoBuffer.addSample(value, 0.5f);
+                echoBuffer.cycle();
+                for (auto r = 0; r < repeat; ++r) {
+                  sum += echoBuffer.getSample(r);
+                }
+              }
+              sink += sum;
+            },
+            blockSize);
+        addResult({name, sampleRate, blockSize, 1, "repeat=" + String(repeat), nanoseconds});
+      }
+    }
+  }
+}
+
+void BenchmarkSuite::runAntiAliasFilter() {
+  const String name = "antiAliasFilter::process";
+  if (!shouldRun(name)) {
+    return;
+  }
+
+  const auto numChannels = 2;
+  for (const auto sampleRate : sampleRates) {
+    for (const auto blockSize : blockSizes) {
+      antiAliasFilter filter;
+      filter.prepare((std::int32_t)sampleRate, UP_SAMPLING_FACTOR);
+
+      // プロセッサと同じくサブブロックごとに間引く
+      AudioBuffer<float> buffer(numChannels, blockSize);
+      AudioBuffer<float> upSampleBuffer(numChannels, SUB_BLOCK_SIZE * UP_SAMPLING_FACTOR);
+      Random random(1);
+      const auto nanoseconds = measure(
+          [&](std::int32_t numSamples) {
+            for (auto start = 0; start < numSamples; start += SUB_BLOCK_SIZE) {
+              const auto size = jmin(SUB_BLOCK_SIZE, numSamples - start);
+              auto* upSampled = upSampleBuffer.getWritePointer(0);
+              for (auto i = 0; i < size * UP_SAMPLING_FACTOR; ++i) {
+                upSampled[i] = random.nextFloat() - 0.5f;
+              }
+              filter.process(buffer, start, size, upSampleBuffer, 0, numChannels);
+            }
+            sink += buffer.getSample(0, 0);
+          },
+          blockSize);
+      addResult({name, sampleRate, blockSize, 1, "", nanoseconds});
+    }
+  }
+}
+
+void BenchmarkSuite::runSoftClipper() {
+  const String clipperName = "SoftClipper::processSamples";
+  const String tanhName = "SoftClipper::tanhfReference";
+  const auto isClipperEnabled = shouldRun(clipperName);
+  const auto isTanhEnabled = shouldRun(tanhName);
+  if (!isClipperEnabled && !isTanhEnabled) {
+    return;
+  }
+
+  // ドライブを深くしたときのように, 振幅が0から振り切れる範囲まで変わるサインをステレオで処理する
+  const auto numChannels = 2;
+  for (const auto sampleRate : sampleRates) {
+    for (const auto blockSize : blockSizes) {
+      AudioBuffer<float> buffer(numChannels, blockSize);
+      auto phase = 0.0;
+      auto fill = [&](std::int32_t numSamples) {
+        for (auto i = 0; i < numSamples; ++i) {
+          const auto amplitude = (float)(2.0 + 2.0 * std::sin(phase * 0.001));
+          const auto value = amplitude * (float)std::sin(phase);
+          for (auto channel = 0; channel < numChannels; ++channel) {
+            buffer.setSample(channel, i, value);
+          }
+          phase = std::fmod(phase + TWO_PI * 440.0 / sampleRate, TWO_PI * 1000.0);
+        }
+      };
+
+      if (isClipperEnabled) {
+        SoftClipper clipper;
+        clipper.prepare(numChannels);
+        const auto nanoseconds = measure(
+            [&](std::int32_t numSamples) {
+              fill(numSamples);
+              for (auto channel = 0; channel < numChannels; ++channel) {
+                clipper.processSamples(channel, buffer.getWritePointer(channel), numSamples);
+              }
+              sink += buffer.getSample(0, 0);
+            },
+            blockSize);
+        addResult({clipperName, sampleRate, blockSize, 1, "", nanoseconds});
+      }
+
+      // 置き換える前のWaveShaperと同じtanhfとの比較用
+      if (isTanhEnabled) {
+        const auto nanoseconds = measure(
+            [&](std::int32_t numSamples) {
+              fill(numSamples);
+              for (auto channel = 0; channel < numChannels; ++channel) {
+                auto* data = buffer.getWritePointer(channel);
+                for (auto i = 0; i < numSamples; ++i) {
+                  data[i] = std::tanh(data[i]);
+                }
+              }
+              sink += buffer.getSample(0, 0);
+            },
+            blockSize);
+        addResult({tanhName, sampleRate, blockSize, 1, "", nanoseconds});
+      }
+    }
+  }
+}
+
+void BenchmarkSuite::runVoice() {
+  const String name = "SimpleVoice::renderNextBlock";
+  if (!shouldRun(name)) {
+    return;
+  }
+
+  auto& p = *parameterOwner;
+  for (const auto features : featureSets) {
+    applyFeatures(p, features);
+    for (const auto sampleRate : sampleRates) {
+      const auto internalRate = sampleRate * UP_SAMPLING_FACTOR;
+      for (const auto blockSize : blockSizes) {
+        // 1ボイスだけのシンセサイザで, ボイスとフィルタバンクのレーン1本分を計測する
+        VoiceFilterBank voiceFilterBank;
+        voiceFilterBank.prepare(internalRate, SUB_BLOCK_SIZE * UP_SAMPLING_FACTOR);
+        const ColorTableBank colorTableBank;
+        VoiceParameterSnapshot parameterSnapshot;
+
+        ChipSynthesiser synth(&p.voicingParameters);
+        synth.setMinimumSubBlockSize(UP_SAMPLING_FACTOR);
+        synth.setCurrentPlaybackSampleRate(internalRate);
+        BigInteger notes, channels;
+        notes.setRange(0, 127, true);
+        channels.setRange(1, 2, true);
+        synth.addSound(new SimpleSound(notes, channels));
+        auto* voice = new SimpleVoice(&p.chipOscParameters, &p.sweepParameters, &p.vibratoParameters,
+                                      &p.voicingParameters, &p.optionsParameters, &p.midiEchoParameters,
+                                      &p.waveformMemoryParameters, &p.wavePatternParameters,
+                                      &p.voiceFilterParameters, &voiceFilterBank, &colorTableBank,
+                                      &parameterSnapshot, 0);
+        synth.addVoice(voice);
+        voice->prepareEchoBuffer(p.midiEchoParameters.EchoDuration->get(), p.midiEchoParameters.EchoRepeat->get());
+
+        AudioBuffer<float> upSampleBuffer(2, SUB_BLOCK_SIZE * UP_SAMPLING_FACTOR);
+        MidiBuffer midiMessages;
+        midiMessages.ensureSize(256);
+        NoteRetrigger retrigger(internalRate, 1);
+
+        const auto nanoseconds = measure(
+            [&](std::int32_t numSamples) {
+              voiceFilterBank.setParameters(
+                  p.voiceFilterParameters.FilterEnable->get(),
+                  toChipType<VOICE_FILTER_TYPE>(p.voiceFilterParameters.FilterType),
+                  p.voiceFilterParameters.Cutoff->get(), p.voiceFilterParameters.Resonance->get());
+              parameterSnapshot.update(p.chipOscParameters, p.sweepParameters, p.vibratoParameters,
+                                       p.optionsParameters, p.midiEchoParameters, p.wavePatternParameters,
+                                       p.voiceFilterParameters, colorTableBank, (float)internalRate);
+
+              for (auto start = 0; start < numSamples; start += SUB_BLOCK_SIZE) {
+                const auto upSize = jmin(SUB_BLOCK_SIZE, numSamples - start) * UP_SAMPLING_FACTOR;
+                upSampleBuffer.clear(0, upSize);
+                midiMessages.clear();
+                retrigger.fill(midiMessages, upSize);
+
+                if (voiceFilterBank.isEnabled()) {
+                  voiceFilterBank.beginBlock(upSize);
+                }
+                synth.renderBlock(upSampleBuffer, midiMessages, 0, upSize);
+                if (voiceFilterBank.isEnabled()) {
+                  voiceFilterBank.process(upSampleBuffer, 0, upSize);
+                }
+              }
+              sink += upSampleBuffer.getSample(0, 0);
+            },
+            blockSize);
+        addResult({name, sampleRate, blockSize, 1, getFeatureName(features), nanoseconds});
+      }
+    }
+  }
+  applyFeatures(p, 0);
+}
+
+void BenchmarkSuite::runProcessBlock() {
+  const String name = "PluginProcessor::processBlock";
+  if (!shouldRun(name)) {
+    return;
+  }
+
+  for (const auto features : featureSets) {
+    for (const auto numVoices : voiceCounts) {
+      for (const auto sampleRate : sampleRates) {
+        for (const auto blockSize : blockSizes) {
+          RenderSettings settings;
+          settings.sampleRate = sampleRate;
+          settings.blockSize = blockSize;
+          settings.configure = [features](PluginProcessor& processor) { applyFeatures(processor, features); };
+
+          OfflineRenderer renderer(settings);
+          String error;
+          if (!renderer.prepare(error)) {
+            continue;
+          }
+          auto& processor = renderer.getProcessor();
+
+          AudioBuffer<float> buffer(settings.numChannels, blockSize);
+          MidiBuffer midiMessages;
+          midiMessages.ensureSize(1024);
+          NoteRetrigger retrigger(sampleRate, numVoices);
+
+          const auto nanoseconds = measure(
+              [&](std::int32_t numSamples) {
+                midiMessages.clear();
+                retrigger.fill(midiMessages, numSamples);
+                buffer.clear();
+                processor.processBlock(buffer, midiMessages);
+                sink += buffer.getSample(0, 0);
+              },
+              blockSize);
+          addResult({name, sampleRate, blockSize, numVoices, getFeatureName(features), nanoseconds});
+        }
+      }
+    }
+  }
+}
+
+double BenchmarkSuite::measure(const std::function<void(std::int32_t)>& process, std::int32_t samplesPerCall) {
+  // 初回の確保やキャッシュの影響を除くため, 1回空回ししてから計測する
+  process(samplesPerCall);
+
+  const auto numTrials = options.quick ? 3 : 5;
+  const auto secondsPerTrial = options.secondsPerCase / numTrials;
+
+  // 1回の計測がタイマーの分解能より十分長くなるように呼び出し回数を決める
+  const auto probeStart = Time::getHighResolutionTicks();
+  process(samplesPerCall);
+  const auto probeSeconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - probeStart);
+  const auto numCalls = jlimit(1, 1 << 20, (int)(secondsPerTrial / jmax(probeSeconds, 1.0e-9)));
+
+  auto best = std::numeric_limits<double>::max();
+  for (auto trial = 0; trial < numTrials; ++trial) {
+    const auto start = Time::getHighResolutionTicks();
+    for (auto i = 0; i < numCalls; ++i) {
+      process(samplesPerCall);
+    }
+    const auto seconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start);
+    best = jmin(best, seconds * 1.0e9 / ((double)numCalls * samplesPerCall));
+  }
+  return best;
+}
+
+bool BenchmarkSuite::shouldRun(const String& name) const {
+  return options.filter.isEmpty() || name.containsIgnoreCase(options.filter);
+}
+
+void BenchmarkSuite::addResult(BenchmarkResult result) {
+  result.realtimeFactor =
+      result.nanosecondsPerSample > 0.0 ? 1.0e9 / (result.nanosecondsPerSample * result.sampleRate) : 0.0;
+  if (result.features.isEmpty()) {
+    result.features = "default";
+  }
+  results.push_back(result);
+  if (onResult) {
+    onResult(result);
+  }
+}
+
+String BenchmarkSuite::getFeatureName(std::int32_t features) {
+  if (features == 0) {
+    return "plain";
+  }
+
+  StringArray names;
+  if (features & FEATURE_ECHO) names.add("echo");
+  if (features & FEATURE_VOICE_FILTER) names.add("voicefilter");
+  if (features & FEATURE_POST_FILTERS) names.add("filters");
+  if (features & FEATURE_MODULATION) names.add("modulation");
+  return names.joinIntoString("+");
+}
+
+void BenchmarkSuite::applyFeatures(PluginProcessor& p, std::int32_t features) {
+  const auto echo = (features & FEATURE_ECHO) != 0;
+  *p.midiEchoParameters.IsEchoEnable = echo;
+  *p.midiEchoParameters.EchoRepeat = echo ? 3 : 1;
+
+  // エンベロープでカットオフを動かし, 係数の更新も含める
+  const auto voiceFilter = (features & FEATURE_VOICE_FILTER) != 0;
+  *p.voiceFilterParameters.FilterEnable = voiceFilter;
+  *p.voiceFilterParameters.Cutoff = voiceFilter ? 2000.0f : 20000.0f;
+  *p.voiceFilterParameters.EnvAmount = voiceFilter ? 2.0f : 0.0f;
+  *p.voiceFilterParameters.Decay = voiceFilter ? 0.2f : 0.0f;
+  *p.voiceFilterParameters.Sustain = voiceFilter ? 0.3f : 1.0f;
+
+  const auto postFilters = (features & FEATURE_POST_FILTERS) != 0;
+  *p.filterParameters.HicutEnable = postFilters;
+  *p.filterParameters.LowcutEnable = postFilters;
+  *p.filterParameters.HicutFreq = postFilters ? 8000.0f : 20000.0f;
+  *p.filterParameters.LowcutFreq = postFilters ? 200.0f : 40.0f;
+
+  const auto modulation = (features & FEATURE_MODULATION) != 0;
+  *p.vibratoParameters.VibratoEnable = modulation;
+  *p.sweepParameters.SweepSwitch = modulation ? 1 : 0;
+}
+
+var BenchmarkSuite::toJson() const {
+  Array<var> resultArray;
+  for (const auto& result : results) {
+    resultArray.add(result.toVar());
+  }
+
+  DynamicObject::Ptr root(new DynamicObject());
+  root->setProperty("format", "SANA_8BIT_VST benchmark");
+  root->setProperty("version", 1);
+  root->setProperty("timestamp", Time::getCurrentTime().toISO8601(true));
+#if JUCE_DEBUG
+  root->setProperty("build", "Debug");
+#else
+  root->setProperty("build", "Release");
+#endif
+  root->setProperty("quick", options.quick);
+  root->setProperty("results", resultArray);
+  return var(root.get());
+}
+
+bool BenchmarkSuite::loadBaseline(const File& file, std::map<String, double>& baseline, String& error) {
+  var root;
+  const auto parseResult = JSON::parse(file.loadFileAsString(), root);
+  if (parseResult.failed()) {
+    error = "cannot parse baseline " + file.getFullPathName() + ": " + parseResult.getErrorMessage();
+    return false;
+  }
+
+  const auto* resultArray = root.getProperty("results", var()).getArray();
+  if (resultArray == nullptr) {
+    error = "baseline has no results: " + file.getFullPathName();
+    return false;
+  }
+
+  baseline.clear();
+  for (const auto& result : *resultArray) {
+    baseline[result.getProperty("key", "").toString()] = (double)result.getProperty("nsPerSample", 0.0);
+  }
+  return true;
+}
+
+std::vector<BenchmarkRegression> BenchmarkSuite::compare(const std::map<String, double>& baseline,
+                                                         double tolerance) const {
+  std::vector<BenchmarkRegression> regressions;
+  for (const auto& result : results) {
+    const auto it = baseline.find(result.getKey());
+    if (it == baseline.end() || it->second <= 0.0) {
+      continue;
+    }
+    if (result.nanosecondsPerSample > it->second * (1.0 + tolerance)) {
+      regressions.push_back({result.getKey(), it->second, result.nanosecondsPerSample});
+    }
+  }
+  return regressions;
+}
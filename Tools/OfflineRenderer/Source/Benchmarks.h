@@ -0,0 +1,106 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "../../../Source/PluginProcessor.h"
+
+/*
+--------------------------------------------------------------------------------
+BenchmarkSuite
+波形関数, エンベロープ, エコー, アンチエイリアス, クリッパー, ボイス, processBlock全体の
+1サンプルあたりの処理時間を, ブロックサイズ/サンプルレート/ボイス数/機能の組み合わせごとに計測する.
+各ケースはウォームアップの後に複数回計測し, 最も速かった回の値を採用する.
+結果はJSONで保存でき, 保存済みのベースラインと比較して遅くなったケースを検出する.
+--------------------------------------------------------------------------------
+*/
+struct BenchmarkOptions {
+  // 組み合わせを減らして短時間で終わらせる
+  bool quick = false;
+  // 1ケースあたりの計測時間の目安(秒). 複数回の計測に分けて使う
+  double secondsPerCase = 0.05;
+  // 空でなければ名前にこの文字列を含むケースだけを実行する
+  String filter;
+};
+
+struct BenchmarkResult {
+  String name;
+  double sampleRate = 0.0;
+  std::int32_t blockSize = 0;
+  std::int32_t numVoices = 0;
+  String features;
+  double nanosecondsPerSample = 0.0;
+  // 1より大きければ実時間より速い. ホストのサンプルレートで換算する
+  double realtimeFactor = 0.0;
+
+  // ベースラインとの照合に使うキー
+  String getKey() const;
+  var toVar() const;
+};
+
+struct BenchmarkRegression {
+  String key;
+  double baselineNanoseconds = 0.0;
+  double currentNanoseconds = 0.0;
+};
+
+class BenchmarkSuite {
+ public:
+  using ResultCallback = std::function<void(const BenchmarkResult&)>;
+
+  explicit BenchmarkSuite(const BenchmarkOptions& options);
+  ~BenchmarkSuite();
+
+  void run(const ResultCallback& onResult = nullptr);
+
+  const std::vector<BenchmarkResult>& getResults() const { return results; }
+  var toJson() const;
+
+  // 結果のJSONからキーと1サンプルあたりの時間の対応表を作る
+  static bool loadBaseline(const File& file, std::map<String, double>& baseline, String& error);
+
+  // ベースラインより tolerance (0.1なら10%) を超えて遅くなったケースを返す
+  std::vector<BenchmarkRegression> compare(const std::map<String, double>& baseline, double tolerance) const;
+
+ private:
+  // processBlockとボイスで切り替える機能. 組み合わせて使う
+  enum Feature {
+    FEATURE_ECHO = 1 << 0,
+    FEATURE_VOICE_FILTER = 1 << 1,
+    FEATURE_POST_FILTERS = 1 << 2,
+    FEATURE_MODULATION = 1 << 3,
+  };
+
+  void runWaveforms();
+  void runEnvelopes();
+  void runEchoBuffer();
+  void runAntiAliasFilter();
+  void runSoftClipper();
+  void runVoice();
+  void runProcessBlock();
+
+  // process(numSamples) を繰り返し呼び, 1サンプルあたりの最短時間(ns)を返す
+  double measure(const std::function<void(std::int32_t)>& process, std::int32_t samplesPerCall);
+  bool shouldRun(const String& name) const;
+  void addResult(BenchmarkResult result);
+
+  static String getFeatureName(std::int32_t features);
+  static void applyFeatures(PluginProcessor& processor, std::int32_t features);
+
+  BenchmarkOptions options;
+  ResultCallback onResult;
+  std::vector<BenchmarkResult> results;
+
+  std::vector<double> sampleRates;
+  std::vector<std::int32_t> blockSizes;
+  std::vector<std::int32_t> voiceCounts;
+  std::vector<std::int32_t> featureSets;
+
+  // 単体のDSPクラスへ渡すパラメータの持ち主
+  std::unique_ptr<PluginProcessor> parameterOwner;
+
+  // 計算結果を捨てられないようにするための出力先
+  float sink = 0.0f;
+};
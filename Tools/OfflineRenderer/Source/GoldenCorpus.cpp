@@ -0,0 +1,303 @@
+#include "GoldenCorpus.h"
+
+namespace {
+const std::int32_t FFT_ORDER = 11;
+const std::int32_t FFT_SIZE = 1 << FFT_ORDER;
+// これより小さい振幅は同じ値として扱い, 無音部分の差を無視する
+const float SPECTRAL_FLOOR_DB = -120.0f;
+
+// 波形名をファイル名に使える形にする
+String toCaseName(const String& waveName) {
+  return waveName.replace("%", "").replace(".", "_").replace(" ", "_");
+}
+
+void addNote(MidiMessageSequence& sequence, std::int32_t note, double start, double length) {
+  sequence.addEvent(MidiMessage::noteOn(1, note, (uint8)100), start);
+  sequence.addEvent(MidiMessage::noteOff(1, note), start + length);
+}
+}  // namespace
+
+std::vector<GoldenCase> GoldenCorpus::createCases() {
+  std::vector<GoldenCase> cases;
+
+  // 波形ごと. 他のパラメータは初期値のまま
+  for (auto i = 0; i < NUM_OF_WAVE_TYPES; ++i) {
+    cases.push_back({"wave_" + toCaseName(WAVE_TYPE_INFOS[i].name), -1,
+                     [i](PluginProcessor& p) { *p.chipOscParameters.OscWaveType = i; }});
+  }
+
+  // プリセットごと
+  for (auto i = 0; i < NUM_OF_PRESETS; ++i) {
+    cases.push_back({"preset_" + String(i).paddedLeft('0', 2), i, nullptr});
+  }
+
+  // 代表的な機能の設定
+  cases.push_back({"echo", -1, [](PluginProcessor& p) {
+                     *p.midiEchoParameters.IsEchoEnable = true;
+                     *p.midiEchoParameters.EchoDuration = 0.1f;
+                     *p.midiEchoParameters.EchoRepeat = 3;
+                   }});
+  cases.push_back({"echo_long", -1, [](PluginProcessor& p) {
+                     *p.midiEchoParameters.IsEchoEnable = true;
+                     *p.midiEchoParameters.EchoDuration = 0.25f;
+                     *p.midiEchoParameters.EchoRepeat = 5;
+                     *p.midiEchoParameters.VolumeOffset = 80.0f;
+                   }});
+  cases.push_back({"sweep_positive", -1, [](PluginProcessor& p) {
+                     *p.sweepParameters.SweepSwitch = 1;
+                     *p.sweepParameters.SweepTime = 0.5f;
+                   }});
+  cases.push_back({"sweep_negative", -1, [](PluginProcessor& p) {
+                     *p.sweepParameters.SweepSwitch = 2;
+                     *p.sweepParameters.SweepTime = 0.5f;
+                   }});
+  cases.push_back({"vibrato", -1, [](PluginProcessor& p) {
+                     *p.vibratoParameters.VibratoEnable = true;
+                     *p.vibratoParameters.VibratoAttackDeleySwitch = false;
+                     *p.vibratoParameters.VibratoAmount = 1.0f;
+                     *p.vibratoParameters.VibratoSpeed = 6.0f;
+                   }});
+  cases.push_back({"vibrato_delayed", -1, [](PluginProcessor& p) {
+                     *p.vibratoParameters.VibratoEnable = true;
+                     *p.vibratoParameters.VibratoAttackDeleySwitch = true;
+                     *p.vibratoParameters.VibratoAmount = 1.0f;
+                     *p.vibratoParameters.VibratoAttackTime = 0.1f;
+                   }});
+  cases.push_back({"sweep_ntsc", -1, [](PluginProcessor& p) {
+                     *p.optionsParameters.MacroClock = (int)MACRO_CLOCK_TYPE::NTSC;
+                     *p.sweepParameters.SweepSwitch = 1;
+                     *p.sweepParameters.SweepTime = 0.5f;
+                   }});
+  cases.push_back({"vibrato_pal", -1, [](PluginProcessor& p) {
+                     *p.optionsParameters.MacroClock = (int)MACRO_CLOCK_TYPE::PAL;
+                     *p.vibratoParameters.VibratoEnable = true;
+                     *p.vibratoParameters.VibratoAttackDeleySwitch = false;
+                     *p.vibratoParameters.VibratoAmount = 1.0f;
+                     *p.vibratoParameters.VibratoSpeed = 6.0f;
+                   }});
+  for (const auto loop : {true, false}) {
+    cases.push_back({loop ? "pattern_loop" : "pattern_oneshot", -1, [loop](PluginProcessor& p) {
+                       auto& pattern = p.wavePatternParameters;
+                       *pattern.PatternEnabled = true;
+                       *pattern.LoopEnabled = loop;
+                       *pattern.StepTime = 0.03f;
+                       const std::int32_t waveTypes[WAVEPATTERN_TYPES] = {0, 3, 4, 7};
+                       for (auto i = 0; i < WAVEPATTERN_TYPES; ++i) {
+                         *pattern.WaveTypes[i] = waveTypes[i];
+                       }
+                       for (auto i = 0; i < WAVEPATTERN_LENGTH; ++i) {
+                         *pattern.WavePatternArray[i] = i % WAVEPATTERN_TYPES;
+                       }
+                     }});
+  }
+  cases.push_back({"color_arp", -1, [](PluginProcessor& p) {
+                     *p.chipOscParameters.ColorType = (int)COLOR_TYPE::ARP_MAJOR;
+                     *p.chipOscParameters.ColorDuration = 0.03f;
+                   }});
+  cases.push_back({"color_user", -1, [](PluginProcessor& p) {
+                     // 0, 12, 7, 5 と進み, 2番目のステップから繰り返す
+                     const std::int32_t steps[] = {0, 12, 7, 5};
+                     auto& sequence = p.colorSequenceParameters;
+                     for (auto i = 0; i < (std::int32_t)numElementsInArray(steps); ++i) {
+                       *sequence.Steps[i] = steps[i];
+                     }
+                     *sequence.Length = (int)numElementsInArray(steps);
+                     *sequence.LoopEnabled = true;
+                     *sequence.LoopStart = 1;
+                     *p.chipOscParameters.ColorType = (int)COLOR_TYPE::USER;
+                     *p.chipOscParameters.ColorDuration = 0.03f;
+                   }});
+  cases.push_back({"envelope", -1, [](PluginProcessor& p) {
+                     *p.chipOscParameters.Attack = 0.05f;
+                     *p.chipOscParameters.Decay = 0.1f;
+                     *p.chipOscParameters.Sustain = 0.4f;
+                     *p.chipOscParameters.Release = 0.2f;
+                   }});
+  cases.push_back({"voice_filter", -1, [](PluginProcessor& p) {
+                     *p.voiceFilterParameters.FilterEnable = true;
+                     *p.voiceFilterParameters.Cutoff = 1500.0f;
+                     *p.voiceFilterParameters.Resonance = 2.0f;
+                     *p.voiceFilterParameters.EnvAmount = 2.0f;
+                     *p.voiceFilterParameters.Decay = 0.2f;
+                     *p.voiceFilterParameters.Sustain = 0.2f;
+                   }});
+  cases.push_back({"post_filters", -1, [](PluginProcessor& p) {
+                     *p.filterParameters.HicutEnable = true;
+                     *p.filterParameters.LowcutEnable = true;
+                     *p.filterParameters.HicutFreq = 3000.0f;
+                     *p.filterParameters.LowcutFreq = 300.0f;
+                   }});
+  cases.push_back({"drive", -1, [](PluginProcessor& p) { *p.chipOscParameters.VolumeLevel = 8.0f; }});
+  cases.push_back({"mono", -1, [](PluginProcessor& p) { *p.voicingParameters.VoicingSwitch = 1; }});
+  cases.push_back({"portamento", -1, [](PluginProcessor& p) {
+                     *p.voicingParameters.VoicingSwitch = 2;
+                     *p.voicingParameters.StepTime = 0.1f;
+                   }});
+  cases.push_back({"mono_low_priority", -1, [](PluginProcessor& p) {
+                     *p.voicingParameters.VoicingSwitch = 1;
+                     *p.voicingParameters.NotePriority = (int)NOTE_PRIORITY_TYPE::LOW;
+                   }});
+  cases.push_back({"portamento_legato_rate", -1, [](PluginProcessor& p) {
+                     *p.voicingParameters.VoicingSwitch = 2;
+                     *p.voicingParameters.StepTime = 0.2f;
+                     *p.voicingParameters.GlideMode = (int)GLIDE_MODE_TYPE::CONSTANT_RATE;
+                     *p.voicingParameters.Legato = true;
+                   }});
+  return cases;
+}
+
+MidiMessageSequence GoldenCorpus::createPhrase() {
+  MidiMessageSequence sequence;
+
+  // 単音の上昇と, 音域の両端
+  const std::int32_t notes[] = {60, 64, 67, 72, 36, 96};
+  auto time = 0.0;
+  for (const auto note : notes) {
+    addNote(sequence, note, time, 0.2);
+    time += 0.25;
+  }
+
+  // レガートで重なるノート(モノ/ポルタメント用)
+  addNote(sequence, 60, time, 0.3);
+  addNote(sequence, 67, time + 0.15, 0.3);
+  time += 0.6;
+
+  // ピッチベンド
+  addNote(sequence, 69, time, 0.4);
+  sequence.addEvent(MidiMessage::pitchWheel(1, 12288), time + 0.1);
+  sequence.addEvent(MidiMessage::pitchWheel(1, 4096), time + 0.2);
+  sequence.addEvent(MidiMessage::pitchWheel(1, 8192), time + 0.3);
+  time += 0.5;
+
+  // 和音
+  for (const auto note : {48, 55, 60, 64, 67}) {
+    addNote(sequence, note, time, 0.5);
+  }
+
+  sequence.updateMatchedPairs();
+  return sequence;
+}
+
+bool GoldenCorpus::render(const GoldenCase& goldenCase, AudioBuffer<float>& output, String& error) {
+  RenderSettings settings;
+  settings.sampleRate = SAMPLE_RATE;
+  settings.blockSize = BLOCK_SIZE;
+  settings.tailSeconds = TAIL_SECONDS;
+  settings.presetIndex = goldenCase.presetIndex;
+  settings.configure = goldenCase.configure;
+
+  OfflineRenderer renderer(settings);
+  if (!renderer.prepare(error)) {
+    return false;
+  }
+  renderer.renderToBuffer(createPhrase(), output);
+  return true;
+}
+
+bool GoldenCorpus::writeWav(const File& file, const AudioBuffer<float>& buffer, String& error) {
+  auto writer = OfflineRenderer::createWavWriter(file, SAMPLE_RATE, buffer.getNumChannels(), error, 32);
+  if (writer == nullptr) {
+    return false;
+  }
+  if (!writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples())) {
+    error = "cannot write " + file.getFullPathName();
+    return false;
+  }
+  return true;
+}
+
+bool GoldenCorpus::readWav(const File& file, AudioBuffer<float>& buffer, double& sampleRate, String& error) {
+  WavAudioFormat wavFormat;
+  std::unique_ptr<AudioFormatReader> reader(wavFormat.createReaderFor(new FileInputStream(file), true));
+  if (reader == nullptr) {
+    error = "cannot read reference " + file.getFullPathName();
+    return false;
+  }
+
+  sampleRate = reader->sampleRate;
+  buffer.setSize((int)reader->numChannels, (int)reader->lengthInSamples);
+  reader->read(&buffer, 0, (int)reader->lengthInSamples, 0, true, true);
+  return true;
+}
+
+GoldenComparison GoldenCorpus::compare(const AudioBuffer<float>& reference, const AudioBuffer<float>& rendered,
+                                       const GoldenTolerance& tolerance) {
+  GoldenComparison result;
+
+  if (reference.getNumChannels() != rendered.getNumChannels()) {
+    result.reason = "channel count " + String(rendered.getNumChannels()) + " != reference " +
+                    String(reference.getNumChannels());
+    return result;
+  }
+  if (reference.getNumSamples() != rendered.getNumSamples()) {
+    result.reason = "length " + String(rendered.getNumSamples()) + " != reference " +
+                    String(reference.getNumSamples());
+    return result;
+  }
+
+  auto sumOfSquares = 0.0;
+  for (auto channel = 0; channel < reference.getNumChannels(); ++channel) {
+    const auto* expected = reference.getReadPointer(channel);
+    const auto* actual = rendered.getReadPointer(channel);
+    for (auto i = 0; i < reference.getNumSamples(); ++i) {
+      const auto error = std::abs((double)actual[i] - (double)expected[i]);
+      sumOfSquares += error * error;
+      if (error > 0.0 && (result.firstDifferentSample < 0 || i < result.firstDifferentSample)) {
+        result.firstDifferentSample = i;
+      }
+      if (error > result.maxAbsError) {
+        result.maxAbsError = error;
+        result.maxErrorSample = i;
+        result.maxErrorChannel = channel;
+      }
+    }
+  }
+
+  const auto numValues = (double)jmax(1, reference.getNumChannels() * reference.getNumSamples());
+  result.rmsErrorDb = Decibels::gainToDecibels(std::sqrt(sumOfSquares / numValues), -200.0);
+  result.spectralDistanceDb = getSpectralDistanceDb(reference, rendered);
+
+  if (result.maxAbsError > tolerance.maxAbsError) {
+    result.reason = "max abs error " + String(result.maxAbsError, 9) + " > " + String(tolerance.maxAbsError, 9);
+  } else if (tolerance.maxSpectralDistanceDb >= 0.0 &&
+             result.spectralDistanceDb > tolerance.maxSpectralDistanceDb) {
+    result.reason = "spectral distance " + String(result.spectralDistanceDb, 3) + " dB > " +
+                    String(tolerance.maxSpectralDistanceDb, 3) + " dB";
+  } else {
+    result.passed = true;
+  }
+  return result;
+}
+
+double GoldenCorpus::getSpectralDistanceDb(const AudioBuffer<float>& reference, const AudioBuffer<float>& rendered) {
+  dsp::FFT fft(FFT_ORDER);
+  dsp::WindowingFunction<float> window((size_t)FFT_SIZE, dsp::WindowingFunction<float>::hann, false);
+  std::vector<float> expected((size_t)FFT_SIZE * 2), actual((size_t)FFT_SIZE * 2);
+
+  auto distanceSum = 0.0;
+  auto numFrames = 0;
+  const auto hopSize = FFT_SIZE / 2;
+
+  for (auto channel = 0; channel < reference.getNumChannels(); ++channel) {
+    for (auto start = 0; start + FFT_SIZE <= reference.getNumSamples(); start += hopSize) {
+      std::fill(expected.begin(), expected.end(), 0.0f);
+      std::fill(actual.begin(), actual.end(), 0.0f);
+      std::copy_n(reference.getReadPointer(channel, start), FFT_SIZE, expected.begin());
+      std::copy_n(rendered.getReadPointer(channel, start), FFT_SIZE, actual.begin());
+      window.multiplyWithWindowingTable(expected.data(), (size_t)FFT_SIZE);
+      window.multiplyWithWindowingTable(actual.data(), (size_t)FFT_SIZE);
+      fft.performFrequencyOnlyForwardTransform(expected.data());
+      fft.performFrequencyOnlyForwardTransform(actual.data());
+
+      auto frameSum = 0.0;
+      for (auto bin = 0; bin <= FFT_SIZE / 2; ++bin) {
+        const auto a = jmax(SPECTRAL_FLOOR_DB, Decibels::gainToDecibels(expected[(size_t)bin], SPECTRAL_FLOOR_DB));
+        const auto b = jmax(SPECTRAL_FLOOR_DB, Decibels::gainToDecibels(actual[(size_t)bin], SPECTRAL_FLOOR_DB));
+        frameSum += (double)(a - b) * (a - b);
+      }
+      distanceSum += std::sqrt(frameSum / (FFT_SIZE / 2 + 1));
+      ++numFrames;
+    }
+  }
+  return numFrames > 0 ? distanceSum / numFrames : 0.0;
+}
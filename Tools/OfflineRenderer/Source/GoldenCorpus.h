@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "OfflineRenderer.h"
+
+/*
+--------------------------------------------------------------------------------
+GoldenCorpus
+波形の種類, プリセット, エコー/スイープ/ビブラート/パターンなどの設定ごとに決まったフレーズを
+レンダリングし, 保存済みの参照WAVと比較する. 最適化で出力が変わっていないことの確認に使う.
+各ケースは新しいプロセッサで描画するので, ノイズの乱数や LFSR は毎回同じ状態から始まる.
+参照WAVは32ビット浮動小数点で保存するため, ビット単位での比較もできる.
+--------------------------------------------------------------------------------
+*/
+struct GoldenCase {
+  String name;
+  // 0以上ならプリセットを読み込んでから configure を適用する
+  std::int32_t presetIndex = -1;
+  std::function<void(PluginProcessor&)> configure;
+};
+
+struct GoldenTolerance {
+  // サンプルごとの差の絶対値の最大. 0ならビット単位で一致する必要がある
+  double maxAbsError = 0.0;
+  // 対数スペクトル距離(dB)の上限. 負の値なら判定に使わない
+  double maxSpectralDistanceDb = -1.0;
+};
+
+struct GoldenComparison {
+  bool passed = false;
+  // 不一致の理由. 一致した場合は空
+  String reason;
+  double maxAbsError = 0.0;
+  std::int64_t maxErrorSample = -1;
+  std::int32_t maxErrorChannel = -1;
+  // 最初に差が出たサンプル. 差がなければ-1
+  std::int64_t firstDifferentSample = -1;
+  double rmsErrorDb = -200.0;
+  double spectralDistanceDb = 0.0;
+};
+
+class GoldenCorpus {
+ public:
+  static constexpr double SAMPLE_RATE = 48000.0;
+  static constexpr std::int32_t BLOCK_SIZE = 512;
+  static constexpr double TAIL_SECONDS = 1.5;
+
+  static std::vector<GoldenCase> createCases();
+
+  // 全ケースで共通のフレーズ. 単音, 音域の端, ピッチベンド, 和音を含む
+  static MidiMessageSequence createPhrase();
+
+  static bool render(const GoldenCase& goldenCase, AudioBuffer<float>& output, String& error);
+
+  static bool writeWav(const File& file, const AudioBuffer<float>& buffer, String& error);
+  static bool readWav(const File& file, AudioBuffer<float>& buffer, double& sampleRate, String& error);
+
+  static GoldenComparison compare(const AudioBuffer<float>& reference, const AudioBuffer<float>& rendered,
+                                  const GoldenTolerance& tolerance);
+
+ private:
+  // 窓をかけたフレームごとの対数振幅スペクトルの差のRMSを全フレームで平均する
+  static double getSpectralDistanceDb(const AudioBuffer<float>& reference, const AudioBuffer<float>& rendered);
+};
@@ -0,0 +1,597 @@
+/*
+  ==============================================================================
+
+    SANA_OfflineRenderer
+    ホストなしでPluginProcessorを動かすコマンドラインツール.
+
+  ==============================================================================
+*/
+
+#include <iostream>
+
+#include "Benchmarks.h"
+#include "GoldenCorpus.h"
+#include "OfflineRenderer.h"
+#include "OnsetCheck.h"
+#include "RealtimeChecker.h"
+#include "ScalingBenchmark.h"
+#include "SoftClipperCheck.h"
+#include "StressTest.h"
+
+namespace {
+RenderSettings parseRenderSettings(const ArgumentList& args) {
+  RenderSettings settings;
+  if (args.containsOption("--rate")) {
+    settings.sampleRate = args.getValueForOption("--rate").getDoubleValue();
+  }
+  if (args.containsOption("--block")) {
+    settings.blockSize = args.getValueForOption("--block").getIntValue();
+  }
+  if (args.containsOption("--tail")) {
+    settings.tailSeconds = args.getValueForOption("--tail").getDoubleValue();
+  }
+  if (args.containsOption("--preset")) {
+    settings.presetIndex = args.getValueForOption("--preset").getIntValue();
+  }
+  if (args.containsOption("--state")) {
+    settings.stateFile = args.getExistingFileForOption("--state");
+  }
+
+  if (settings.sampleRate <= 0.0) {
+    ConsoleApplication::fail("--rate must be positive");
+  }
+  if (settings.blockSize <= 0) {
+    ConsoleApplication::fail("--block must be positive");
+  }
+  return settings;
+}
+
+void renderCommand(const ArgumentList& args) {
+  const auto midiFile = args.getExistingFileForOption("--midi");
+  const auto outputFile = args.getFileForOption("--out");
+  const auto settings = parseRenderSettings(args);
+
+  String error;
+  MidiMessageSequence sequence;
+  if (!OfflineRenderer::loadMidiFile(midiFile, sequence, error)) {
+    ConsoleApplication::fail(error);
+  }
+
+  OfflineRenderer renderer(settings);
+  if (!renderer.prepare(error)) {
+    ConsoleApplication::fail(error);
+  }
+
+  // プリセットから状態ファイルを作れるように, 読み込んだ状態を保存できるようにしておく
+  if (args.containsOption("--save-state")) {
+    MemoryBlock state;
+    renderer.getProcessor().getStateInformation(state);
+    args.getFileForOption("--save-state").replaceWithData(state.getData(), state.getSize());
+  }
+
+  auto writer = OfflineRenderer::createWavWriter(outputFile, settings.sampleRate, settings.numChannels, error);
+  if (writer == nullptr) {
+    ConsoleApplication::fail(error);
+  }
+
+  const auto result = renderer.render(sequence, writer.get());
+  writer.reset();
+
+  std::cout << "rendered   : " << outputFile.getFullPathName() << std::endl
+            << "audio      : " << String(result.audioSeconds, 3) << " s (" << result.numSamples << " samples, "
+            << result.numBlocks << " blocks of " << settings.blockSize << ")" << std::endl
+            << "processing : " << String(result.renderSeconds, 3) << " s" << std::endl
+            << "RTF        : " << String(result.getRealtimeFactor(), 2) << "x realtime" << std::endl
+            << "peak       : " << String(Decibels::gainToDecibels(result.peakLevel), 2) << " dBFS" << std::endl;
+}
+
+void benchCommand(const ArgumentList& args) {
+  BenchmarkOptions options;
+  options.quick = args.containsOption("--quick");
+  if (args.containsOption("--seconds")) {
+    options.secondsPerCase = args.getValueForOption("--seconds").getDoubleValue();
+  }
+  if (args.containsOption("--filter")) {
+    options.filter = args.getValueForOption("--filter");
+  }
+  const auto tolerance =
+      args.containsOption("--tolerance") ? args.getValueForOption("--tolerance").getDoubleValue() : 0.1;
+
+  if (options.secondsPerCase <= 0.0) {
+    ConsoleApplication::fail("--seconds must be positive");
+  }
+
+  // 実行前にベースラインを読んでおき, 読めなければ計測せずに終える
+  std::map<String, double> baseline;
+  if (args.containsOption("--baseline")) {
+    String error;
+    if (!BenchmarkSuite::loadBaseline(args.getExistingFileForOption("--baseline"), baseline, error)) {
+      ConsoleApplication::fail(error);
+    }
+  }
+
+  BenchmarkSuite suite(options);
+  suite.run([](const BenchmarkResult& result) {
+    std::cout << String::formatted("%-30s %6d Hz %5d smp %d vo  %-36s %10.2f ns/smp %10.1fx",
+                                   result.name.toRawUTF8(), (int)result.sampleRate, result.blockSize,
+                                   result.numVoices, result.features.toRawUTF8(), result.nanosecondsPerSample,
+                                   result.realtimeFactor)
+              << std::endl;
+  });
+
+  if (args.containsOption("--out")) {
+    const auto outputFile = args.getFileForOption("--out");
+    if (!outputFile.replaceWithText(JSON::toString(suite.toJson()))) {
+      ConsoleApplication::fail("cannot write " + outputFile.getFullPathName());
+    }
+    std::cout << "results    : " << outputFile.getFullPathName() << std::endl;
+  }
+
+  if (!baseline.empty()) {
+    const auto regressions = suite.compare(baseline, tolerance);
+    for (const auto& regression : regressions) {
+      std::cout << "REGRESSION " << regression.key << ": " << String(regression.baselineNanoseconds, 2)
+                << " -> " << String(regression.currentNanoseconds, 2) << " ns/smp (+"
+                << String((regression.currentNanoseconds / regression.baselineNanoseconds - 1.0) * 100.0, 1)
+                << "%)" << std::endl;
+    }
+    if (!regressions.empty()) {
+      ConsoleApplication::fail(String((int)regressions.size()) + " case(s) slower than the baseline by more than " +
+                               String(tolerance * 100.0, 1) + "%");
+    }
+    std::cout << "baseline   : no regressions (tolerance " << String(tolerance * 100.0, 1) << "%)" << std::endl;
+  }
+}
+
+void clipcheckCommand(const ArgumentList&) {
+  const auto result = SoftClipperCheck::run();
+
+  std::cout << String::formatted("%-4s pade vs tanh   max abs %.3e (limit %.3e)", result.isPadePassed() ? "ok" : "FAIL",
+                                 result.padeMaxError, SoftClipperCheck::MAX_PADE_ERROR)
+            << std::endl
+            << String::formatted("%-4s adaa vs exact  max abs %.3e (limit %.3e)", result.isAdaaPassed() ? "ok" : "FAIL",
+                                 result.adaaMaxError, SoftClipperCheck::MAX_ADAA_ERROR)
+            << std::endl
+            << String::formatted("     sine sweep at amplitude %.1f, alias power relative to the harmonics",
+                                 (double)SoftClipperCheck::SWEEP_AMPLITUDE)
+            << std::endl;
+  for (const auto& step : result.sweep) {
+    std::cout << String::formatted("%-4s %8.0f Hz  naive %7.1f dB  adaa %7.1f dB  (%+.1f dB)", step.passed ? "ok" : "FAIL",
+                                   step.frequency, step.naiveAliasDb, step.adaaAliasDb,
+                                   step.adaaAliasDb - step.naiveAliasDb)
+              << std::endl;
+  }
+
+  if (!result.isPadePassed() || !result.isAdaaPassed() || !result.isSweepPassed()) {
+    ConsoleApplication::fail("SoftClipper accuracy check failed");
+  }
+}
+
+void onsetCommand(const ArgumentList& args) {
+  OnsetSettings settings;
+  if (args.containsOption("--rate")) {
+    settings.sampleRate = args.getValueForOption("--rate").getDoubleValue();
+  }
+  if (settings.sampleRate <= 0.0) {
+    ConsoleApplication::fail("--rate must be positive");
+  }
+  if (args.containsOption("--block")) {
+    settings.blockSizes.clear();
+    for (const auto& blockSize : StringArray::fromTokens(args.getValueForOption("--block"), ",", "")) {
+      if (blockSize.getIntValue() <= 0) {
+        ConsoleApplication::fail("invalid block size " + blockSize);
+      }
+      settings.blockSizes.push_back(blockSize.getIntValue());
+    }
+  }
+  if (args.containsOption("--offsets")) {
+    settings.offsets.clear();
+    for (const auto& offset : StringArray::fromTokens(args.getValueForOption("--offsets"), ",", "")) {
+      if (offset.getIntValue() < 0) {
+        ConsoleApplication::fail("invalid offset " + offset);
+      }
+      settings.offsets.push_back(offset.getIntValue());
+    }
+  }
+
+  std::vector<OnsetResult> results;
+  std::int64_t latency = 0;
+  String error;
+  OnsetCheck check(settings);
+  if (!check.run(results, latency, error)) {
+    ConsoleApplication::fail(error);
+  }
+
+  std::cout << "latency    : " << latency << " samples (note-on at 0, 1-sample blocks)" << std::endl;
+  auto numFailed = 0;
+  for (const auto& result : results) {
+    if (!result.isPassed()) {
+      ++numFailed;
+    }
+    std::cout << String::formatted("%-4s block %5d  offset %5d  onset %6lld  expected %6lld",
+                                   result.isPassed() ? "ok" : "FAIL", result.blockSize, result.offset,
+                                   (long long)result.onsetSample, (long long)result.expectedSample)
+              << std::endl;
+  }
+
+  if (numFailed > 0) {
+    ConsoleApplication::fail(String(numFailed) + " of " + String((int)results.size()) +
+                             " case(s) started at the wrong sample");
+  }
+}
+
+void goldenCommand(const ArgumentList& args) {
+  const auto directory = args.getFileForOption("--dir");
+  const auto isRecording = args.containsOption("--record");
+  const auto filter = args.getValueForOption("--filter");
+
+  GoldenTolerance tolerance;
+  if (args.containsOption("--max-abs")) {
+    tolerance.maxAbsError = args.getValueForOption("--max-abs").getDoubleValue();
+  }
+  if (args.containsOption("--max-spectral-db")) {
+    tolerance.maxSpectralDistanceDb = args.getValueForOption("--max-spectral-db").getDoubleValue();
+  }
+  const auto actualDirectory = args.containsOption("--actual") ? args.getFileForOption("--actual") : File();
+
+  if (isRecording) {
+    directory.createDirectory();
+  } else if (!directory.isDirectory()) {
+    ConsoleApplication::fail("reference directory not found: " + directory.getFullPathName());
+  }
+  if (actualDirectory != File()) {
+    actualDirectory.createDirectory();
+  }
+
+  StringArray failedCases;
+  auto numCases = 0;
+  for (const auto& goldenCase : GoldenCorpus::createCases()) {
+    if (filter.isNotEmpty() && !goldenCase.name.containsIgnoreCase(filter)) {
+      continue;
+    }
+    ++numCases;
+
+    String error;
+    AudioBuffer<float> rendered;
+    if (!GoldenCorpus::render(goldenCase, rendered, error)) {
+      ConsoleApplication::fail(goldenCase.name + ": " + error);
+    }
+
+    const auto referenceFile = directory.getChildFile(goldenCase.name + ".wav");
+    if (isRecording) {
+      if (!GoldenCorpus::writeWav(referenceFile, rendered, error)) {
+        ConsoleApplication::fail(error);
+      }
+      std::cout << "recorded   " << goldenCase.name << std::endl;
+      continue;
+    }
+
+    AudioBuffer<float> reference;
+    auto sampleRate = 0.0;
+    GoldenComparison comparison;
+    if (!GoldenCorpus::readWav(referenceFile, reference, sampleRate, error)) {
+      comparison.reason = error;
+    } else if (sampleRate != GoldenCorpus::SAMPLE_RATE) {
+      comparison.reason = "reference sample rate " + String(sampleRate);
+    } else {
+      comparison = GoldenCorpus::compare(reference, rendered, tolerance);
+    }
+
+    std::cout << String::formatted("%-4s %-24s max abs %.3e", comparison.passed ? "ok" : "FAIL",
+                                   goldenCase.name.toRawUTF8(), comparison.maxAbsError)
+              << "  rms " << String(comparison.rmsErrorDb, 1) << " dB  spectral "
+              << String(comparison.spectralDistanceDb, 3) << " dB" << std::endl;
+
+    if (!comparison.passed) {
+      std::cout << "     " << comparison.reason << std::endl;
+      if (comparison.firstDifferentSample >= 0) {
+        std::cout << "     first difference at sample " << comparison.firstDifferentSample << " ("
+                  << String(comparison.firstDifferentSample / GoldenCorpus::SAMPLE_RATE, 4)
+                  << " s), largest at sample " << comparison.maxErrorSample << " on channel "
+                  << comparison.maxErrorChannel << std::endl;
+      }
+      failedCases.add(goldenCase.name);
+
+      // 差分を聴いて確認できるよう, 今回の出力を残す
+      if (actualDirectory != File()) {
+        GoldenCorpus::writeWav(actualDirectory.getChildFile(goldenCase.name + ".wav"), rendered, error);
+      }
+    }
+  }
+
+  if (numCases == 0) {
+    ConsoleApplication::fail("no case matches --filter " + filter);
+  }
+  if (!failedCases.isEmpty()) {
+    ConsoleApplication::fail(String(failedCases.size()) + " of " + String(numCases) +
+                             " case(s) diverged: " + failedCases.joinIntoString(", "));
+  }
+  std::cout << (isRecording ? "recorded " : "passed ") << numCases << " case(s) in "
+            << directory.getFullPathName() << std::endl;
+}
+
+void rtcheckCommand(const ArgumentList& args) {
+  if (!RealtimeChecker::isSupported()) {
+    ConsoleApplication::fail("rtcheck is only supported on Linux (glibc)");
+  }
+
+  RealtimeStressSettings settings;
+  if (args.containsOption("--rate")) {
+    settings.sampleRate = args.getValueForOption("--rate").getDoubleValue();
+  }
+  if (args.containsOption("--block")) {
+    settings.maxBlockSize = args.getValueForOption("--block").getIntValue();
+  }
+  if (args.containsOption("--seconds")) {
+    settings.seconds = args.getValueForOption("--seconds").getDoubleValue();
+  }
+  if (args.containsOption("--seed")) {
+    settings.seed = args.getValueForOption("--seed").getIntValue();
+  }
+  if (settings.sampleRate <= 0.0 || settings.maxBlockSize <= 0 || settings.seconds <= 0.0) {
+    ConsoleApplication::fail("--rate, --block and --seconds must be positive");
+  }
+  RealtimeChecker::setAllowList(
+      StringArray::fromTokens(args.getValueForOption("--allow"), ",", ""));
+
+  RealtimeChecker::reset();
+  RealtimeStressTest test(settings);
+  RealtimeStressResult result;
+  String error;
+  if (!test.run(result, error)) {
+    ConsoleApplication::fail(error);
+  }
+
+  const auto violations = RealtimeChecker::getViolations();
+  std::cout << "blocks     : " << result.numBlocks << " (max " << settings.maxBlockSize << " samples at "
+            << settings.sampleRate << " Hz)" << std::endl
+            << "midi       : " << result.numMidiEvents << " events" << std::endl
+            << "parameters : " << result.numParameterChanges << " changes" << std::endl
+            << "allowed    : " << RealtimeChecker::getNumAllowed() << std::endl
+            << "violations : " << (int)violations.size() << " call site(s)" << std::endl;
+
+  for (const auto& violation : violations) {
+    std::cout << std::endl
+              << RealtimeChecker::getTypeName(violation.type) << " x" << violation.count << " (first in block "
+              << violation.firstBlock << ")" << std::endl
+              << violation.stackTrace << std::endl;
+  }
+
+  if (!violations.empty()) {
+    ConsoleApplication::fail("processBlock is not real-time safe");
+  }
+}
+
+void stressCommand(const ArgumentList& args) {
+  StressSettings settings;
+  if (args.containsOption("--rate")) {
+    settings.sampleRate = args.getValueForOption("--rate").getDoubleValue();
+  }
+  if (args.containsOption("--seconds")) {
+    settings.seconds = args.getValueForOption("--seconds").getDoubleValue();
+  }
+  if (args.containsOption("--seed")) {
+    settings.seed = args.getValueForOption("--seed").getIntValue();
+  }
+
+  const auto blockSizes = StringArray::fromTokens(
+      args.containsOption("--block") ? args.getValueForOption("--block") : "32,64,128,256,512", ",", "");
+  auto scenarios = StressTest::getScenarioNames();
+  if (args.containsOption("--scenario")) {
+    const auto scenario = args.getValueForOption("--scenario");
+    if (!scenarios.contains(scenario)) {
+      ConsoleApplication::fail("unknown scenario " + scenario + " (" + scenarios.joinIntoString(", ") + ")");
+    }
+    scenarios = StringArray(scenario);
+  }
+  if (settings.sampleRate <= 0.0 || settings.seconds <= 0.0) {
+    ConsoleApplication::fail("--rate and --seconds must be positive");
+  }
+
+  std::cout << String::formatted("%-16s %6s %9s %9s %9s %9s %9s %8s %9s", "scenario", "block", "deadline",
+                                 "avg", "p99", "p99.9", "max", "load", "overruns")
+            << std::endl;
+
+  for (const auto& scenario : scenarios) {
+    // p99.9 と最大値がともに締め切りに収まる最小のブロックサイズ
+    auto smallestSafeBlock = -1;
+    for (const auto& blockSize : blockSizes) {
+      settings.blockSize = blockSize.getIntValue();
+      if (settings.blockSize <= 0) {
+        ConsoleApplication::fail("invalid block size " + blockSize);
+      }
+
+      BlockTimeStats stats;
+      String error;
+      StressTest test(scenario, settings);
+      if (!test.run(stats, error)) {
+        ConsoleApplication::fail(error);
+      }
+
+      std::cout << String::formatted("%-16s %6d %9.1f %9.1f %9.1f %9.1f %9.1f %7.1f%% %9d",
+                                     scenario.toRawUTF8(), settings.blockSize, stats.deadlineMicroseconds,
+                                     stats.avgMicroseconds, stats.p99Microseconds, stats.p999Microseconds,
+                                     stats.maxMicroseconds, stats.getLoadPercent(stats.maxMicroseconds),
+                                     (int)stats.numOverruns)
+                << std::endl;
+
+      if (stats.maxMicroseconds < stats.deadlineMicroseconds &&
+          (smallestSafeBlock < 0 || settings.blockSize < smallestSafeBlock)) {
+        smallestSafeBlock = settings.blockSize;
+      }
+    }
+
+    std::cout << "  -> " << scenario << ": "
+              << (smallestSafeBlock > 0 ? "smallest block within the deadline is " + String(smallestSafeBlock)
+                                        : String("no tested block size stays within the deadline"))
+              << std::endl;
+  }
+}
+
+void scaleCommand(const ArgumentList& args) {
+  ScalingSettings settings;
+  if (args.containsOption("--rate")) {
+    settings.sampleRate = args.getValueForOption("--rate").getDoubleValue();
+  }
+  if (args.containsOption("--block")) {
+    settings.blockSize = args.getValueForOption("--block").getIntValue();
+  }
+  if (args.containsOption("--seconds")) {
+    settings.seconds = args.getValueForOption("--seconds").getDoubleValue();
+  }
+  if (settings.sampleRate <= 0.0 || settings.blockSize <= 0 || settings.seconds <= 0.0) {
+    ConsoleApplication::fail("--rate, --block and --seconds must be positive");
+  }
+
+  const auto instanceCounts = StringArray::fromTokens(
+      args.containsOption("--instances") ? args.getValueForOption("--instances") : "1,8,32", ",", "");
+  const auto threadCounts = StringArray::fromTokens(
+      args.containsOption("--threads") ? args.getValueForOption("--threads")
+                                       : "1,2,4," + String(SystemStats::getNumCpus()),
+      ",", "");
+
+  std::cout << String::formatted("%9s %7s %8s %6s %9s %9s %8s %10s %8s %9s %9s %9s", "instances", "threads",
+                                 "RT inst", "eff", "avg[us]", "p99[us]", "slowdown", "cycle[us]", "overruns",
+                                 "locks", "contended", "mem[KB]")
+            << std::endl;
+
+  for (const auto& instanceCount : instanceCounts) {
+    settings.numInstances = instanceCount.getIntValue();
+    if (settings.numInstances <= 0) {
+      ConsoleApplication::fail("invalid instance count " + instanceCount);
+    }
+
+    // 1スレッドの結果を基準にスレッドを増やしたときの効率と1インスタンスあたりの遅くなり方を求める
+    ScalingResult singleThread;
+    auto hasSingleThread = false;
+    for (const auto& threadCount : threadCounts) {
+      settings.numThreads = threadCount.getIntValue();
+      if (settings.numThreads <= 0) {
+        ConsoleApplication::fail("invalid thread count " + threadCount);
+      }
+
+      ScalingResult result;
+      String error;
+      ScalingBenchmark benchmark(settings);
+      if (!benchmark.run(result, error)) {
+        ConsoleApplication::fail(error);
+      }
+      if (settings.numThreads == 1) {
+        singleThread = result;
+        hasSingleThread = true;
+      }
+
+      const auto efficiency = hasSingleThread && singleThread.realtimeInstances > 0.0
+                                  ? result.realtimeInstances / (singleThread.realtimeInstances * settings.numThreads)
+                                  : 0.0;
+      const auto slowdown = hasSingleThread && singleThread.avgInstanceMicroseconds > 0.0
+                                ? result.avgInstanceMicroseconds / singleThread.avgInstanceMicroseconds
+                                : 0.0;
+      std::cout << String::formatted("%9d %7d %8.1f %5.0f%% %9.1f %9.1f %7.2fx %10.1f %8d %9lld %9lld %9.0f",
+                                     settings.numInstances, settings.numThreads, result.realtimeInstances,
+                                     efficiency * 100.0, result.avgInstanceMicroseconds,
+                                     result.p99InstanceMicroseconds, slowdown, result.maxCycleMicroseconds,
+                                     (int)result.numCycleOverruns, (long long)result.numLocks,
+                                     (long long)result.numContendedLocks, result.memoryPerInstanceBytes / 1024.0)
+                << std::endl;
+    }
+  }
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  ConsoleApplication app;
+
+  app.addHelpCommand("--help|-h", "Usage: SANA_OfflineRenderer <command> [options]", true);
+
+  app.addCommand({"render",
+                  "render --midi <file.mid> --out <file.wav> [--preset <n>] [--state <file>] "
+                  "[--block <n>] [--rate <hz>] [--tail <sec>] [--save-state <file>]",
+                  "Renders a Standard MIDI File to WAV and reports the real-time factor.",
+                  "The processor is created without a host or editor. --preset loads a factory program, "
+                  "--state loads a blob written by getStateInformation (applied after --preset). "
+                  "Defaults: 48000 Hz, 512-sample blocks, 2 s tail.",
+                  renderCommand});
+
+  app.addCommand({"bench",
+                  "bench [--out <results.json>] [--baseline <results.json>] [--tolerance <ratio>] "
+                  "[--quick] [--filter <name>] [--seconds <sec>]",
+                  "Runs the micro benchmarks and optionally compares them with a stored baseline.",
+                  "Measures ns per host sample of each Waveforms function, AmpEnvelope::cycle/renderBlock, ColorEnvelope::cycle, "
+                  "EchoBuffer, antiAliasFilter::process, SoftClipper::processSamples (with tanhf as a reference), "
+                  "SimpleVoice::renderNextBlock and the full processBlock "
+                  "across block sizes, sample rates, voice counts and feature sets. Each case keeps the best of "
+                  "several timed runs. With --baseline the command fails when any case is slower than the "
+                  "baseline by more than --tolerance (default 0.1 = 10%). --quick runs a reduced matrix. "
+                  "Build the Release configuration before recording a baseline.",
+                  benchCommand});
+
+  app.addCommand({"clipcheck",
+                  "clipcheck",
+                  "Checks the accuracy and anti-aliasing of the output soft clipper.",
+                  "Fails if the Pade clip function is more than 0.03 from tanh, if the float ADAA difference "
+                  "quotient is more than 1e-5 from a long double reference, or if, on a stepped sine sweep "
+                  "driven past the knee, ADAA does not reduce the alias power by at least 3 dB against "
+                  "clipping each sample (steps where naive clipping aliases below -100 dB are exempt).",
+                  clipcheckCommand});
+
+  app.addCommand({"onset",
+                  "onset [--block <n,n,...>] [--offsets <n,n,...>] [--rate <hz>]",
+                  "Checks that notes start at the sample of their note-on for any block size.",
+                  "Renders a single square-wave note with no attack, placed at each host sample offset, "
+                  "with each block size, and finds the first sample above -80 dBFS. The onset of a note at "
+                  "offset 0 rendered in 1-sample blocks is the fixed latency; every other case must start "
+                  "exactly at offset + latency. Defaults: blocks 1,32,64,100,256,512,1024,4096; offsets "
+                  "0,1,2,31,63,64,65,127,255,511,777,1000,4097 (sub-block and block boundaries); 48000 Hz.",
+                  onsetCommand});
+
+  app.addCommand({"golden",
+                  "golden --dir <reference dir> [--record] [--filter <name>] [--max-abs <value>] "
+                  "[--max-spectral-db <dB>] [--actual <dir>]",
+                  "Renders the golden corpus and compares it with stored reference WAVs.",
+                  "The corpus covers every oscillator wave type, every factory program and representative "
+                  "echo, sweep, vibrato, pattern, color, filter and voicing settings, all playing the same "
+                  "built-in phrase at 48000 Hz. --record (re)writes the references as 32-bit float WAVs. "
+                  "Without it every case must match bit for bit unless --max-abs and/or --max-spectral-db "
+                  "(mean log-spectral distance) are given. --actual keeps the renders of diverging cases.",
+                  goldenCommand});
+
+  app.addCommand({"rtcheck",
+                  "rtcheck [--seconds <sec>] [--block <max>] [--rate <hz>] [--seed <n>] "
+                  "[--allow <substring,...>]",
+                  "Fails if processBlock allocates, frees or locks a mutex under a MIDI stress load.",
+                  "malloc/calloc/realloc/free/posix_memalign/aligned_alloc and pthread_mutex_lock are "
+                  "intercepted while processBlock runs. The load is a seeded random stream of chords, voice "
+                  "steals, same-sample bursts, pitch bend and controllers, with parameter and program changes "
+                  "and queued MIDI between blocks and a varying block size. Each offending call site is "
+                  "printed once with its stack trace. Stack traces containing an --allow substring are "
+                  "counted but not reported. Defaults: 20 s, 512-sample maximum blocks, 48000 Hz. "
+                  "Linux only.",
+                  rtcheckCommand});
+
+  app.addCommand({"stress",
+                  "stress [--scenario <name>] [--block <n,n,...>] [--rate <hz>] [--seconds <sec>] [--seed <n>]",
+                  "Measures worst-case block times under synthetic worst-case MIDI against the buffer deadline.",
+                  "Scenarios: all_notes (128 simultaneous notes), retrigger_storm (chord retriggered every 1 ms), "
+                  "voicing_switch (POLY/MONO/PORTAMENTO switched every block), automation (main parameters "
+                  "changed every block) and combined. Each scenario runs once per block size and prints the "
+                  "average, p99, p99.9 and maximum processBlock time against the block's real-time deadline, "
+                  "plus the smallest block size whose worst case fits. Timings come from a normal-priority "
+                  "thread, so leave headroom for the host. Defaults: all scenarios, blocks 32,64,128,256,512, "
+                  "48000 Hz, 10 s.",
+                  stressCommand});
+
+  app.addCommand({"scale",
+                  "scale [--instances <n,n,...>] [--threads <n,n,...>] [--block <n>] [--rate <hz>] "
+                  "[--seconds <sec>]",
+                  "Drives N processor instances from M host threads and reports how throughput scales.",
+                  "Every cycle, each instance renders one block, and the threads take instances from a shared "
+                  "ticket counter. This is how a DAW spreads tracks over its audio workers. Reports: real-time "
+                  "instance capacity, scaling efficiency against one thread, per-instance block time and its "
+                  "slowdown against one thread, worst cycle time and overruns, mutex locks and contended "
+                  "locks taken inside processBlock (Linux), and resident memory per instance. "
+                  "Defaults: 1,8,32 instances; 1,2,4 and all cores; 256-sample blocks; 48000 Hz; 5 s.",
+                  scaleCommand});
+
+  return app.findAndRunCommand(argc, argv);
+}
@@ -0,0 +1,167 @@
+#include "OfflineRenderer.h"
+
+OfflineRenderer::OfflineRenderer(const RenderSettings& s) : settings(s) {}
+
+bool OfflineRenderer::prepare(String& error) {
+  processor.reset(new PluginProcessor());
+
+  if (settings.presetIndex >= 0) {
+    if (settings.presetIndex >= processor->getNumPrograms()) {
+      error = "preset index out of range: " + String(settings.presetIndex);
+      return false;
+    }
+    // 現在のプログラム番号を同期してから切り替える
+    processor->getCurrentProgram();
+    processor->setCurrentProgram(settings.presetIndex);
+  }
+
+  if (settings.stateFile != File()) {
+    MemoryBlock state;
+    if (!settings.stateFile.loadFileAsData(state)) {
+      error = "cannot read state file: " + settings.stateFile.getFullPathName();
+      return false;
+    }
+    processor->setStateInformation(state.getData(), (int)state.getSize());
+  }
+
+  if (settings.configure) {
+    settings.configure(*processor);
+  }
+
+  processor->setPlayConfigDetails(0, settings.numChannels, settings.sampleRate, settings.blockSize);
+  processor->setNonRealtime(true);
+  processor->prepareToPlay(settings.sampleRate, settings.blockSize);
+  return true;
+}
+
+RenderResult OfflineRenderer::render(const MidiMessageSequence& sequence, AudioFormatWriter* writer,
+                                     const BlockCallback& onBlock) {
+  return renderInternal(
+      sequence,
+      [writer](const AudioBuffer<float>& buffer, std::int64_t, std::int32_t numSamples) {
+        if (writer != nullptr) {
+          writer->writeFromAudioSampleBuffer(buffer, 0, numSamples);
+        }
+      },
+      onBlock);
+}
+
+RenderResult OfflineRenderer::renderToBuffer(const MidiMessageSequence& sequence, AudioBuffer<float>& destination) {
+  destination.setSize(settings.numChannels, (int)getTotalNumSamples(sequence));
+  destination.clear();
+  return renderInternal(
+      sequence,
+      [&destination](const AudioBuffer<float>& buffer, std::int64_t position, std::int32_t numSamples) {
+        for (auto channel = 0; channel < destination.getNumChannels(); ++channel) {
+          destination.copyFrom(channel, (int)position, buffer, channel, 0, numSamples);
+        }
+      },
+      nullptr);
+}
+
+std::int64_t OfflineRenderer::getTotalNumSamples(const MidiMessageSequence& sequence) const {
+  const auto endTime = sequence.getNumEvents() > 0 ? sequence.getEndTime() : 0.0;
+  return (std::int64_t)std::ceil((endTime + settings.tailSeconds) * settings.sampleRate);
+}
+
+RenderResult OfflineRenderer::renderInternal(const MidiMessageSequence& sequence, const OutputCallback& onOutput,
+                                             const BlockCallback& onBlock) {
+  jassert(processor != nullptr);
+
+  const auto sampleRate = settings.sampleRate;
+  const auto totalSamples = getTotalNumSamples(sequence);
+
+  AudioBuffer<float> buffer(settings.numChannels, settings.blockSize);
+  MidiBuffer midiMessages;
+  midiMessages.ensureSize(4096);
+
+  RenderResult result;
+  auto eventIndex = 0;
+  const auto numEvents = sequence.getNumEvents();
+
+  for (std::int64_t position = 0; position < totalSamples; position += settings.blockSize) {
+    const auto numSamples = (std::int32_t)jmin((std::int64_t)settings.blockSize, totalSamples - position);
+    const auto blockEnd = position + numSamples;
+
+    // このブロックに含まれるイベントをブロック先頭からのサンプル位置で詰める
+    midiMessages.clear();
+    while (eventIndex < numEvents) {
+      const auto& message = sequence.getEventPointer(eventIndex)->message;
+      const auto samplePosition = (std::int64_t)std::floor(message.getTimeStamp() * sampleRate);
+      if (samplePosition >= blockEnd) {
+        break;
+      }
+      if (!message.isMetaEvent()) {
+        midiMessages.addEvent(message, (int)jmax((std::int64_t)0, samplePosition - position));
+      }
+      ++eventIndex;
+    }
+
+    buffer.setSize(settings.numChannels, numSamples, false, false, true);
+    buffer.clear();
+
+    const auto start = Time::getHighResolutionTicks();
+    processor->processBlock(buffer, midiMessages);
+    const auto seconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start);
+
+    result.renderSeconds += seconds;
+    if (onBlock) {
+      onBlock(result.numBlocks, numSamples, seconds);
+    }
+    ++result.numBlocks;
+
+    for (auto channel = 0; channel < buffer.getNumChannels(); ++channel) {
+      result.peakLevel = jmax(result.peakLevel, buffer.getMagnitude(channel, 0, numSamples));
+    }
+
+    onOutput(buffer, position, numSamples);
+  }
+
+  result.numSamples = totalSamples;
+  result.audioSeconds = (double)totalSamples / sampleRate;
+  return result;
+}
+
+bool OfflineRenderer::loadMidiFile(const File& file, MidiMessageSequence& sequence, String& error) {
+  FileInputStream stream(file);
+  if (!stream.openedOk()) {
+    error = "cannot open MIDI file: " + file.getFullPathName();
+    return false;
+  }
+
+  MidiFile midiFile;
+  if (!midiFile.readFrom(stream)) {
+    error = "not a Standard MIDI File: " + file.getFullPathName();
+    return false;
+  }
+  midiFile.convertTimestampTicksToSeconds();
+
+  sequence.clear();
+  for (auto i = 0; i < midiFile.getNumTracks(); ++i) {
+    sequence.addSequence(*midiFile.getTrack(i), 0.0);
+  }
+  sequence.updateMatchedPairs();
+  return true;
+}
+
+std::unique_ptr<AudioFormatWriter> OfflineRenderer::createWavWriter(const File& file, double sampleRate,
+                                                                    std::int32_t numChannels, String& error,
+                                                                    std::int32_t bitsPerSample) {
+  file.deleteFile();
+  std::unique_ptr<FileOutputStream> stream(file.createOutputStream());
+  if (stream == nullptr) {
+    error = "cannot create output file: " + file.getFullPathName();
+    return nullptr;
+  }
+
+  WavAudioFormat wavFormat;
+  std::unique_ptr<AudioFormatWriter> writer(
+      wavFormat.createWriterFor(stream.get(), sampleRate, (unsigned int)numChannels, bitsPerSample, {}, 0));
+  if (writer == nullptr) {
+    error = "cannot create WAV writer";
+    return nullptr;
+  }
+  // ストリームはwriterが所有する
+  stream.release();
+  return writer;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include "../../../Source/PluginProcessor.h"
+
+/*
+--------------------------------------------------------------------------------
+OfflineRenderer
+ホストやGUIなしでPluginProcessorを生成し, MIDIシーケンスを任意のブロックサイズで
+processBlockへ流し込む. 出力はWAVへ書き出せる.
+processBlockにかかった時間だけを計測し, 実時間比(RTF)を求める.
+--------------------------------------------------------------------------------
+*/
+struct RenderSettings {
+  double sampleRate = 48000.0;
+  std::int32_t blockSize = 512;
+  std::int32_t numChannels = 2;
+  // MIDIシーケンスの終わりから追加でレンダリングする秒数(リリースやエコー用)
+  double tailSeconds = 2.0;
+  // 0以上ならプリセットを読み込む
+  std::int32_t presetIndex = -1;
+  // 存在すればgetStateInformationで保存した状態を読み込む(プリセットより後に適用する)
+  File stateFile;
+  // 状態の読み込み後, prepareToPlayの前に呼ばれる. パラメータを直接設定したいときに使う
+  std::function<void(PluginProcessor&)> configure;
+};
+
+struct RenderResult {
+  std::int64_t numSamples = 0;
+  std::int32_t numBlocks = 0;
+  // processBlockの処理時間の合計
+  double renderSeconds = 0.0;
+  double audioSeconds = 0.0;
+  float peakLevel = 0.0f;
+
+  // 1より大きければ実時間より速い
+  double getRealtimeFactor() const { return renderSeconds > 0.0 ? audioSeconds / renderSeconds : 0.0; }
+};
+
+class OfflineRenderer {
+ public:
+  // ブロックごとに (ブロック番号, ブロックのサンプル数, processBlockにかかった秒数) を受け取る
+  using BlockCallback = std::function<void(std::int32_t, std::int32_t, double)>;
+
+  explicit OfflineRenderer(const RenderSettings& settings);
+
+  // プロセッサを生成して状態を読み込み, prepareToPlayまで行う
+  bool prepare(String& error);
+
+  // sequenceの時刻は秒単位. writerがnullptrなら書き出さない
+  RenderResult render(const MidiMessageSequence& sequence, AudioFormatWriter* writer,
+                      const BlockCallback& onBlock = nullptr);
+
+  // 出力全体をdestinationへ書き込む. destinationの大きさはレンダリングする長さに合わせて変える
+  RenderResult renderToBuffer(const MidiMessageSequence& sequence, AudioBuffer<float>& destination);
+
+  PluginProcessor& getProcessor() { return *processor; }
+  const RenderSettings& getSettings() const { return settings; }
+
+  // Standard MIDI Fileを読み込み, 全トラックを秒単位の1本のシーケンスにまとめる
+  static bool loadMidiFile(const File& file, MidiMessageSequence& sequence, String& error);
+
+  // WAVファイルへの書き出し用. 既存のファイルは上書きする. 32ビットは浮動小数点で書き出す
+  static std::unique_ptr<AudioFormatWriter> createWavWriter(const File& file, double sampleRate,
+                                                            std::int32_t numChannels, String& error,
+                                                            std::int32_t bitsPerSample = 24);
+
+ private:
+  // ブロックごとの出力を (バッファ, 出力全体での開始位置, サンプル数) で受け取る
+  using OutputCallback = std::function<void(const AudioBuffer<float>&, std::int64_t, std::int32_t)>;
+
+  std::int64_t getTotalNumSamples(const MidiMessageSequence& sequence) const;
+  RenderResult renderInternal(const MidiMessageSequence& sequence, const OutputCallback& onOutput,
+                              const BlockCallback& onBlock);
+
+  RenderSettings settings;
+  std::unique_ptr<PluginProcessor> processor;
+};
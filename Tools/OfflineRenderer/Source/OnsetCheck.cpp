@@ -0,0 +1,75 @@
+#include "OnsetCheck.h"
+
+namespace {
+// ノートオンからノートオフまでと, その後にレンダリングする秒数
+const double NOTE_SECONDS = 0.05;
+const double TAIL_SECONDS = 0.05;
+
+// 位相が0から始まり, 最初のサンプルから振幅のある波形で, アタックなしに鳴らす
+void configureOnsetVoice(PluginProcessor& p) {
+  // NES_Square50%
+  *p.chipOscParameters.OscWaveType = 0;
+  *p.chipOscParameters.Attack = 0.0f;
+  *p.chipOscParameters.Sustain = 1.0f;
+}
+}  // namespace
+
+OnsetCheck::OnsetCheck(const OnsetSettings& s) : settings(s) {}
+
+bool OnsetCheck::run(std::vector<OnsetResult>& results, std::int64_t& latency, String& error) {
+  // ブロックサイズ1ならイベントは必ずブロックの先頭にあり, 区切り方の影響を受けない
+  if (!detectOnset(1, 0, latency, error)) {
+    return false;
+  }
+  if (latency < 0) {
+    error = "the reference note produced no output";
+    return false;
+  }
+
+  results.clear();
+  for (const auto blockSize : settings.blockSizes) {
+    for (const auto offset : settings.offsets) {
+      OnsetResult result;
+      result.blockSize = blockSize;
+      result.offset = offset;
+      result.expectedSample = offset + latency;
+      if (!detectOnset(blockSize, offset, result.onsetSample, error)) {
+        return false;
+      }
+      results.push_back(result);
+    }
+  }
+  return true;
+}
+
+bool OnsetCheck::detectOnset(std::int32_t blockSize, std::int32_t offset, std::int64_t& onsetSample,
+                             String& error) {
+  RenderSettings renderSettings;
+  renderSettings.sampleRate = settings.sampleRate;
+  renderSettings.blockSize = blockSize;
+  renderSettings.tailSeconds = TAIL_SECONDS;
+  renderSettings.configure = configureOnsetVoice;
+
+  OfflineRenderer renderer(renderSettings);
+  if (!renderer.prepare(error)) {
+    return false;
+  }
+
+  // 秒への変換で前のサンプルへ丸められないよう, サンプルの中央の時刻に置く
+  const auto start = (offset + 0.5) / settings.sampleRate;
+  MidiMessageSequence sequence;
+  sequence.addEvent(MidiMessage::noteOn(1, 69, (uint8)100), start);
+  sequence.addEvent(MidiMessage::noteOff(1, 69), start + NOTE_SECONDS);
+
+  AudioBuffer<float> output;
+  renderer.renderToBuffer(sequence, output);
+
+  onsetSample = -1;
+  for (auto i = 0; i < output.getNumSamples(); ++i) {
+    if (std::abs(output.getSample(0, i)) > ONSET_THRESHOLD) {
+      onsetSample = i;
+      break;
+    }
+  }
+  return true;
+}
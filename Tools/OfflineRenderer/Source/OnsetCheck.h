@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+#include "OfflineRenderer.h"
+
+/*
+--------------------------------------------------------------------------------
+OnsetCheck
+ホストのブロック内の決まった位置にノートオンを置いてレンダリングし, 出力が鳴り始めたサンプルを調べる.
+ブロックサイズ1, 位置0で求めた遅れ(アンチエイリアスなどによる固定の遅れ)を基準に,
+どの位置とブロックサイズでも 鳴り始め = ノートオンの位置 + 基準の遅れ になることを確認する.
+ブロックの境界やサブブロックの境界をまたぐ位置も含める.
+--------------------------------------------------------------------------------
+*/
+struct OnsetSettings {
+  double sampleRate = 48000.0;
+  std::vector<std::int32_t> blockSizes{1, 32, 64, 100, 256, 512, 1024, 4096};
+  std::vector<std::int32_t> offsets{0, 1, 2, 31, 63, 64, 65, 127, 255, 511, 777, 1000, 4097};
+};
+
+struct OnsetResult {
+  std::int32_t blockSize = 0;
+  std::int32_t offset = 0;
+  // 出力が鳴り始めたサンプル. 鳴らなければ-1
+  std::int64_t onsetSample = -1;
+  std::int64_t expectedSample = -1;
+
+  bool isPassed() const { return onsetSample >= 0 && onsetSample == expectedSample; }
+};
+
+class OnsetCheck {
+ public:
+  // この振幅を超えた最初のサンプルを鳴り始めとする
+  static constexpr float ONSET_THRESHOLD = 1.0e-4f;
+
+  explicit OnsetCheck(const OnsetSettings& settings);
+
+  // 基準の遅れを求めてから全ての組み合わせを調べる. 結果はresultsに入る
+  bool run(std::vector<OnsetResult>& results, std::int64_t& latency, String& error);
+
+ private:
+  // ノートオンをoffsetに置いてレンダリングし, 鳴り始めのサンプルを返す
+  bool detectOnset(std::int32_t blockSize, std::int32_t offset, std::int64_t& onsetSample, String& error);
+
+  OnsetSettings settings;
+};
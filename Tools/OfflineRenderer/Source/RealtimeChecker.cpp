@@ -0,0 +1,333 @@
+#include "RealtimeChecker.h"
+
+#include <atomic>
+#include <map>
+
+#if JUCE_LINUX
+#include <errno.h>
+#include <pthread.h>
+#endif
+
+namespace {
+// 監視中のスレッドか, 記録中(記録自体の確保は数えない)か
+thread_local bool isAudioThread = false;
+thread_local bool isReporting = false;
+thread_local std::int64_t currentBlock = -1;
+thread_local bool isCountingLocks = false;
+
+std::atomic<std::int64_t> numLocks{0};
+std::atomic<std::int64_t> numContendedLocks{0};
+
+StringArray& getAllowList() {
+  static StringArray allowList;
+  return allowList;
+}
+
+std::map<String, RealtimeChecker::Violation>& getViolationMap() {
+  static std::map<String, RealtimeChecker::Violation> violations;
+  return violations;
+}
+
+std::int64_t numAllowed = 0;
+
+void record(RealtimeChecker::ViolationType type) {
+  const auto stackTrace = SystemStats::getStackBacktrace();
+  for (const auto& allowed : getAllowList()) {
+    if (stackTrace.contains(allowed)) {
+      ++numAllowed;
+      return;
+    }
+  }
+
+  auto& violation = getViolationMap()[String((int)type) + stackTrace];
+  if (violation.count == 0) {
+    violation.type = type;
+    violation.stackTrace = stackTrace;
+    violation.firstBlock = currentBlock;
+  }
+  ++violation.count;
+}
+
+inline void check(RealtimeChecker::ViolationType type) {
+  if (isAudioThread && !isReporting) {
+    isReporting = true;
+    record(type);
+    isReporting = false;
+  }
+}
+}  // namespace
+
+#if JUCE_LINUX
+// glibcの実体を直接呼ぶ. dlsymは内部で確保やロックを行うので使わない
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* pointer);
+int __pthread_mutex_lock(pthread_mutex_t* mutex);
+int __pthread_mutex_trylock(pthread_mutex_t* mutex);
+
+void* malloc(size_t size) noexcept {
+  check(RealtimeChecker::ViolationType::ALLOCATION);
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+  check(RealtimeChecker::ViolationType::ALLOCATION);
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) noexcept {
+  check(RealtimeChecker::ViolationType::ALLOCATION);
+  return __libc_realloc(pointer, size);
+}
+
+int posix_memalign(void** pointer, size_t alignment, size_t size) noexcept {
+  check(RealtimeChecker::ViolationType::ALLOCATION);
+  auto* allocated = __libc_memalign(alignment, size);
+  if (allocated == nullptr) {
+    return ENOMEM;
+  }
+  *pointer = allocated;
+  return 0;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+  check(RealtimeChecker::ViolationType::ALLOCATION);
+  return __libc_memalign(alignment, size);
+}
+
+void free(void* pointer) noexcept {
+  if (pointer != nullptr) {
+    check(RealtimeChecker::ViolationType::DEALLOCATION);
+  }
+  __libc_free(pointer);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept {
+  check(RealtimeChecker::ViolationType::LOCK);
+  if (isCountingLocks) {
+    // すぐに取れなければ他のスレッドと競合している
+    numLocks.fetch_add(1, std::memory_order_relaxed);
+    if (__pthread_mutex_trylock(mutex) == 0) {
+      return 0;
+    }
+    numContendedLocks.fetch_add(1, std::memory_order_relaxed);
+  }
+  return __pthread_mutex_lock(mutex);
+}
+}
+#endif
+
+RealtimeChecker::ScopedAudioThread::ScopedAudioThread(std::int64_t blockIndex) {
+  currentBlock = blockIndex;
+  isAudioThread = true;
+}
+
+RealtimeChecker::ScopedAudioThread::~ScopedAudioThread() { isAudioThread = false; }
+
+RealtimeChecker::ScopedLockCounter::ScopedLockCounter() { isCountingLocks = true; }
+
+RealtimeChecker::ScopedLockCounter::~ScopedLockCounter() { isCountingLocks = false; }
+
+bool RealtimeChecker::isSupported() {
+#if JUCE_LINUX
+  return true;
+#else
+  return false;
+#endif
+}
+
+void RealtimeChecker::setAllowList(const StringArray& allowList) { getAllowList() = allowList; }
+
+void RealtimeChecker::reset() {
+  getViolationMap().clear();
+  numAllowed = 0;
+}
+
+std::vector<RealtimeChecker::Violation> RealtimeChecker::getViolations() {
+  std::vector<Violation> violations;
+  for (const auto& entry : getViolationMap()) {
+    violations.push_back(entry.second);
+  }
+  // 最初に起きた順に並べる
+  std::sort(violations.begin(), violations.end(),
+            [](const Violation& a, const Violation& b) { return a.firstBlock < b.firstBlock; });
+  return violations;
+}
+
+std::int64_t RealtimeChecker::getNumAllowed() { return numAllowed; }
+
+void RealtimeChecker::resetLockCounts() {
+  numLocks.store(0);
+  numContendedLocks.store(0);
+}
+
+std::int64_t RealtimeChecker::getNumLocks() { return numLocks.load(); }
+
+std::int64_t RealtimeChecker::getNumContendedLocks() { return numContendedLocks.load(); }
+
+const char* RealtimeChecker::getTypeName(ViolationType type) {
+  switch (type) {
+    case ViolationType::ALLOCATION:
+      return "allocation";
+    case ViolationType::DEALLOCATION:
+      return "deallocation";
+    case ViolationType::LOCK:
+      return "mutex lock";
+  }
+  return "";
+}
+
+RealtimeStressTest::RealtimeStressTest(const RealtimeStressSettings& s) : settings(s), random(s.seed) {}
+
+bool RealtimeStressTest::run(RealtimeStressResult& result, String& error) {
+  RenderSettings renderSettings;
+  renderSettings.sampleRate = settings.sampleRate;
+  renderSettings.blockSize = settings.maxBlockSize;
+
+  OfflineRenderer renderer(renderSettings);
+  if (!renderer.prepare(error)) {
+    return false;
+  }
+  auto& processor = renderer.getProcessor();
+
+  AudioBuffer<float> buffer(renderSettings.numChannels, settings.maxBlockSize);
+  MidiBuffer midiMessages;
+  midiMessages.ensureSize(8192);
+  heldNotes.ensureStorageAllocated(128);
+
+  const auto totalSamples = (std::int64_t)(settings.seconds * settings.sampleRate);
+  const auto parameterInterval = (std::int64_t)(settings.sampleRate * 0.1);
+  std::int64_t nextParameterChange = parameterInterval;
+
+  for (std::int64_t position = 0; position < totalSamples; ++result.numBlocks) {
+    // ホストと同じく最大サイズを超えない範囲でブロックの長さを変える
+    const auto numSamples =
+        random.nextInt(4) == 0 ? settings.maxBlockSize : 1 + random.nextInt(settings.maxBlockSize);
+
+    // ここから下, processBlockまではホストのメッセージスレッドにあたるので監視しない
+    if (position >= nextParameterChange) {
+      changeParameters(processor, result);
+      // ホストではタイマーから呼ばれる
+      processor.updateEchoBuffers();
+      nextParameterChange += parameterInterval;
+    }
+    if (random.nextInt(8) == 0) {
+      processor.getMidiEventQueue().push(MidiMessage::noteOn(1, 36 + random.nextInt(60), (uint8)90),
+                                         random.nextInt(numSamples));
+      ++result.numMidiEvents;
+    }
+
+    midiMessages.clear();
+    fillMidi(midiMessages, numSamples, result);
+    buffer.setSize(renderSettings.numChannels, numSamples, false, false, true);
+    buffer.clear();
+
+    {
+      RealtimeChecker::ScopedAudioThread audioThread(result.numBlocks);
+      processor.processBlock(buffer, midiMessages);
+    }
+    position += numSamples;
+  }
+  return true;
+}
+
+void RealtimeStressTest::fillMidi(MidiBuffer& midiMessages, std::int32_t numSamples,
+                                  RealtimeStressResult& result) {
+  // 4ブロックに1回は同じ時刻に大量のイベントを詰める
+  const auto isBurst = random.nextInt(4) == 0;
+  const auto numEvents = isBurst ? 32 : random.nextInt(6);
+  const auto burstPosition = random.nextInt(numSamples);
+
+  for (auto i = 0; i < numEvents; ++i) {
+    const auto samplePosition = isBurst ? burstPosition : random.nextInt(numSamples);
+    const auto kind = random.nextInt(10);
+
+    if (kind < 5 || heldNotes.isEmpty()) {
+      // ボイス数より多く重ねて奪い合いを起こす
+      const auto note = 24 + random.nextInt(84);
+      midiMessages.addEvent(MidiMessage::noteOn(1, note, (uint8)(1 + random.nextInt(127))), samplePosition);
+      heldNotes.addIfNotAlreadyThere(note);
+    } else if (kind < 8) {
+      const auto index = random.nextInt(heldNotes.size());
+      midiMessages.addEvent(MidiMessage::noteOff(1, heldNotes[index]), samplePosition);
+      heldNotes.remove(index);
+    } else if (kind == 8) {
+      midiMessages.addEvent(MidiMessage::pitchWheel(1, random.nextInt(16384)), samplePosition);
+    } else {
+      // モジュレーション, ボリューム, サステイン, オールサウンドオフ, オールノートオフ
+      const std::int32_t controllers[] = {1, 7, 64, 120, 123};
+      const auto controller = controllers[random.nextInt(numElementsInArray(controllers))];
+      midiMessages.addEvent(MidiMessage::controllerEvent(1, controller, random.nextInt(128)), samplePosition);
+      if (controller == 120 || controller == 123) {
+        heldNotes.clearQuick();
+      }
+    }
+    ++result.numMidiEvents;
+  }
+}
+
+void RealtimeStressTest::changeParameters(PluginProcessor& p, RealtimeStressResult& result) {
+  for (auto i = 1 + random.nextInt(3); --i >= 0;) {
+    switch (random.nextInt(12)) {
+      case 0:
+        *p.chipOscParameters.OscWaveType = random.nextInt(NUM_OF_WAVE_TYPES);
+        break;
+      case 1:
+        *p.midiEchoParameters.IsEchoEnable = random.nextBool();
+        *p.midiEchoParameters.EchoDuration = 0.01f + random.nextFloat() * 0.5f;
+        *p.midiEchoParameters.EchoRepeat = 1 + random.nextInt(5);
+        break;
+      case 2:
+        *p.voicingParameters.VoicingSwitch = random.nextInt(NUM_OF_VOICING_TYPES);
+        *p.voicingParameters.StepTime = random.nextFloat() * 0.3f;
+        *p.voicingParameters.GlideMode = random.nextInt(NUM_OF_GLIDE_MODE_TYPES);
+        *p.voicingParameters.Legato = random.nextBool();
+        *p.voicingParameters.NotePriority = random.nextInt(NUM_OF_NOTE_PRIORITY_TYPES);
+        break;
+      case 3:
+        *p.sweepParameters.SweepSwitch = random.nextInt(NUM_OF_SWEEP_TYPES);
+        *p.sweepParameters.SweepTime = 0.01f + random.nextFloat();
+        break;
+      case 4:
+        *p.vibratoParameters.VibratoEnable = random.nextBool();
+        *p.vibratoParameters.VibratoAmount = random.nextFloat() * 12.0f;
+        break;
+      case 5:
+        *p.wavePatternParameters.PatternEnabled = random.nextBool();
+        *p.wavePatternParameters.LoopEnabled = random.nextBool();
+        *p.wavePatternParameters.StepTime = 0.01f + random.nextFloat() * 0.2f;
+        break;
+      case 6:
+        *p.chipOscParameters.ColorType = random.nextInt(NUM_OF_COLOR_TYPES);
+        break;
+      case 7:
+        *p.filterParameters.HicutEnable = random.nextBool();
+        *p.filterParameters.LowcutEnable = random.nextBool();
+        *p.filterParameters.HicutFreq = 40.0f + random.nextFloat() * 19960.0f;
+        *p.filterParameters.LowcutFreq = 40.0f + random.nextFloat() * 19960.0f;
+        break;
+      case 8:
+        *p.voiceFilterParameters.FilterEnable = random.nextBool();
+        *p.voiceFilterParameters.FilterType = random.nextInt(NUM_OF_VOICE_FILTER_TYPES);
+        *p.voiceFilterParameters.Cutoff = 40.0f + random.nextFloat() * 19960.0f;
+        *p.voiceFilterParameters.Resonance = 0.1f + random.nextFloat() * 9.9f;
+        break;
+      case 9:
+        *p.chipOscParameters.Attack = random.nextFloat() * 0.1f;
+        *p.chipOscParameters.Decay = random.nextFloat() * 0.5f;
+        *p.chipOscParameters.Sustain = random.nextFloat();
+        *p.chipOscParameters.Release = random.nextFloat() * 0.3f;
+        break;
+      case 10:
+        *p.chipOscParameters.VolumeLevel = -32.0f + random.nextFloat() * 40.0f;
+        break;
+      default:
+        p.setCurrentProgram(random.nextInt(NUM_OF_PRESETS));
+        break;
+    }
+    ++result.numParameterChanges;
+  }
+}
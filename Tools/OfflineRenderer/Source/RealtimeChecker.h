@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector>
+
+#include "OfflineRenderer.h"
+
+/*
+--------------------------------------------------------------------------------
+RealtimeChecker
+processBlockの実行中にオーディオスレッドでメモリの確保/解放やミューテックスのロックが
+起きていないかを調べる. malloc/calloc/realloc/free/posix_memalign/aligned_alloc と
+pthread_mutex_lock を差し替え, ScopedAudioThreadの有効な間に呼ばれたものを
+呼び出し元のスタックトレースごとにまとめて記録する.
+ScopedLockCounterの間はロックの回数と競合した回数だけを数える.
+差し替えはglibcを使うLinuxのみ対応する.
+--------------------------------------------------------------------------------
+*/
+class RealtimeChecker {
+ public:
+  enum class ViolationType { ALLOCATION, DEALLOCATION, LOCK };
+
+  struct Violation {
+    ViolationType type;
+    String stackTrace;
+    std::int64_t count = 0;
+    // 最初に起きたブロックの番号
+    std::int64_t firstBlock = -1;
+  };
+
+  // このスコープの間, 現在のスレッドをオーディオスレッドとして監視する
+  class ScopedAudioThread {
+   public:
+    explicit ScopedAudioThread(std::int64_t blockIndex);
+    ~ScopedAudioThread();
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedAudioThread)
+  };
+
+  // このスコープの間, 現在のスレッドのミューテックスのロック回数と,
+  // 他のスレッドが持っていたため待たされた回数を数える. 違反としては記録しない
+  class ScopedLockCounter {
+   public:
+    ScopedLockCounter();
+    ~ScopedLockCounter();
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedLockCounter)
+  };
+
+  static bool isSupported();
+
+  // スタックトレースにこれらの文字列を含む違反は記録しない
+  static void setAllowList(const StringArray& allowList);
+
+  static void reset();
+  static std::vector<Violation> getViolations();
+  static std::int64_t getNumAllowed();
+
+  static void resetLockCounts();
+  static std::int64_t getNumLocks();
+  static std::int64_t getNumContendedLocks();
+
+  static const char* getTypeName(ViolationType type);
+};
+
+/*
+--------------------------------------------------------------------------------
+RealtimeStressTest
+乱数で作った高密度のMIDI(和音の連打, ボイスの奪い合い, 同時刻の大量のイベント, ピッチベンド,
+コントロールチェンジ)と, ブロックの合間のパラメータ変更やMIDIキューへの送信を流し込み,
+processBlockの間だけRealtimeCheckerで監視する. ブロックサイズも毎回変える.
+--------------------------------------------------------------------------------
+*/
+struct RealtimeStressSettings {
+  double sampleRate = 48000.0;
+  // ホストが指定する最大のブロックサイズ. 実際のブロックはこれ以下でばらつかせる
+  std::int32_t maxBlockSize = 512;
+  double seconds = 20.0;
+  std::int32_t seed = 1;
+};
+
+struct RealtimeStressResult {
+  std::int64_t numBlocks = 0;
+  std::int64_t numMidiEvents = 0;
+  std::int64_t numParameterChanges = 0;
+};
+
+class RealtimeStressTest {
+ public:
+  explicit RealtimeStressTest(const RealtimeStressSettings& settings);
+
+  bool run(RealtimeStressResult& result, String& error);
+
+ private:
+  void fillMidi(MidiBuffer& midiMessages, std::int32_t numSamples, RealtimeStressResult& result);
+  void changeParameters(PluginProcessor& processor, RealtimeStressResult& result);
+
+  RealtimeStressSettings settings;
+  Random random;
+  // 鳴らしているノート. ノートオフはこの中から選ぶ
+  Array<std::int32_t> heldNotes;
+};
@@ -0,0 +1,213 @@
+#include "ScalingBenchmark.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "RealtimeChecker.h"
+
+#if JUCE_LINUX
+#include <unistd.h>
+#endif
+
+namespace {
+const std::int32_t CHORD_NOTES[] = {60, 64, 67};
+
+struct Instance {
+  std::unique_ptr<OfflineRenderer> renderer;
+  AudioBuffer<float> buffer;
+  MidiBuffer midiMessages;
+  std::int64_t position = 0;
+  // 全インスタンスが同時に発音しないよう, 和音を鳴らし直すタイミングをずらす
+  std::int64_t offset = 0;
+};
+}  // namespace
+
+ScalingBenchmark::ScalingBenchmark(const ScalingSettings& s) : settings(s) {}
+
+bool ScalingBenchmark::run(ScalingResult& result, String& error) {
+  const auto numInstances = settings.numInstances;
+  const auto blockSize = settings.blockSize;
+  const auto period = jmax((std::int64_t)1, (std::int64_t)(settings.sampleRate * 0.5));
+
+  const auto residentBefore = getResidentBytes();
+
+  // インスタンスごとに別のプリセットを使う
+  std::vector<std::unique_ptr<Instance>> instances;
+  for (auto i = 0; i < numInstances; ++i) {
+    RenderSettings renderSettings;
+    renderSettings.sampleRate = settings.sampleRate;
+    renderSettings.blockSize = blockSize;
+    renderSettings.presetIndex = i % NUM_OF_PRESETS;
+
+    std::unique_ptr<Instance> instance(new Instance());
+    instance->renderer.reset(new OfflineRenderer(renderSettings));
+    if (!instance->renderer->prepare(error)) {
+      return false;
+    }
+    instance->buffer.setSize(renderSettings.numChannels, blockSize);
+    instance->midiMessages.ensureSize(1024);
+    instance->offset = period * i / numInstances;
+    instances.push_back(std::move(instance));
+  }
+
+  const auto numCycles = (std::int64_t)std::ceil(settings.seconds * settings.sampleRate / blockSize);
+  std::vector<double> instanceTimes((size_t)(numCycles * numInstances));
+
+  const auto processInstance = [&](std::int32_t index, std::int64_t cycleIndex) {
+    auto& instance = *instances[(size_t)index];
+    instance.midiMessages.clear();
+    for (auto i = 0; i < blockSize; ++i) {
+      const auto phase = (instance.position + instance.offset + i) % period;
+      if (phase == 0 || phase == period * 3 / 4) {
+        for (const auto note : CHORD_NOTES) {
+          instance.midiMessages.addEvent(
+              phase == 0 ? MidiMessage::noteOn(1, note, (uint8)100) : MidiMessage::noteOff(1, note), i);
+        }
+      }
+    }
+    instance.buffer.clear();
+
+    const auto start = Time::getHighResolutionTicks();
+    {
+      RealtimeChecker::ScopedLockCounter lockCounter;
+      instance.renderer->getProcessor().processBlock(instance.buffer, instance.midiMessages);
+    }
+    const auto microseconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start) * 1.0e6;
+
+    if (cycleIndex >= 0) {
+      instanceTimes[(size_t)(cycleIndex * numInstances + index)] = microseconds;
+    }
+    instance.position += blockSize;
+  };
+
+  // 初回の処理で起こる確保を済ませてから常駐メモリを測る
+  for (auto i = 0; i < numInstances; ++i) {
+    processInstance(i, -1);
+  }
+  const auto residentAfter = getResidentBytes();
+  if (residentBefore >= 0 && residentAfter >= 0) {
+    result.memoryPerInstanceBytes = (double)(residentAfter - residentBefore) / numInstances;
+  }
+
+  // 通し番号 ticket が (サイクル, インスタンス) を表す. ticketLimit までを各スレッドが取り合う.
+  // 待っているスレッドは回さずに条件変数で眠らせる. サイクルを進めるスレッドも自分でチケットを取る
+  std::atomic<std::int64_t> nextTicket{0};
+  std::atomic<std::int64_t> ticketLimit{0};
+  std::atomic<std::int64_t> numDone{0};
+  bool shouldExit = false;
+  std::mutex mutex;
+  std::condition_variable cycleStarted;
+  std::condition_variable cycleFinished;
+
+  // 残っているチケットを取り切るまで処理する
+  const auto processTickets = [&]() {
+    for (;;) {
+      auto ticket = nextTicket.load(std::memory_order_acquire);
+      const auto limit = ticketLimit.load(std::memory_order_acquire);
+      if (ticket >= limit) {
+        return;
+      }
+      if (!nextTicket.compare_exchange_weak(ticket, ticket + 1, std::memory_order_acq_rel)) {
+        continue;
+      }
+      processInstance((std::int32_t)(ticket % numInstances), ticket / numInstances);
+      if (numDone.fetch_add(1, std::memory_order_acq_rel) + 1 == limit) {
+        std::lock_guard<std::mutex> lock(mutex);
+        cycleFinished.notify_one();
+      }
+    }
+  };
+
+  const auto worker = [&]() {
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cycleStarted.wait(lock, [&]() {
+          return shouldExit ||
+                 nextTicket.load(std::memory_order_acquire) < ticketLimit.load(std::memory_order_acquire);
+        });
+        if (shouldExit) {
+          return;
+        }
+      }
+      processTickets();
+    }
+  };
+
+  RealtimeChecker::resetLockCounts();
+
+  // このスレッドも1本として数える
+  std::vector<std::thread> threads;
+  for (auto i = 1; i < settings.numThreads; ++i) {
+    threads.emplace_back(worker);
+  }
+
+  const auto deadlineMicroseconds = blockSize / settings.sampleRate * 1.0e6;
+  const auto runStart = Time::getHighResolutionTicks();
+  for (std::int64_t cycle = 0; cycle < numCycles; ++cycle) {
+    const auto cycleStart = Time::getHighResolutionTicks();
+    const auto cycleEnd = (cycle + 1) * numInstances;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ticketLimit.store(cycleEnd, std::memory_order_release);
+    }
+    cycleStarted.notify_all();
+
+    processTickets();
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cycleFinished.wait(lock, [&]() { return numDone.load(std::memory_order_acquire) >= cycleEnd; });
+    }
+
+    const auto cycleMicroseconds =
+        Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - cycleStart) * 1.0e6;
+    result.maxCycleMicroseconds = jmax(result.maxCycleMicroseconds, cycleMicroseconds);
+    if (cycleMicroseconds > deadlineMicroseconds) {
+      ++result.numCycleOverruns;
+    }
+  }
+  result.wallSeconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - runStart);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    shouldExit = true;
+  }
+  cycleStarted.notify_all();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  result.numCycles = numCycles;
+  result.numLocks = RealtimeChecker::getNumLocks();
+  result.numContendedLocks = RealtimeChecker::getNumContendedLocks();
+
+  const auto audioSeconds = (double)(numCycles * blockSize) / settings.sampleRate;
+  result.realtimeInstances = result.wallSeconds > 0.0 ? numInstances * audioSeconds / result.wallSeconds : 0.0;
+
+  auto sum = 0.0;
+  for (const auto time : instanceTimes) {
+    sum += time;
+  }
+  result.avgInstanceMicroseconds = instanceTimes.empty() ? 0.0 : sum / (double)instanceTimes.size();
+  std::sort(instanceTimes.begin(), instanceTimes.end());
+  if (!instanceTimes.empty()) {
+    result.p99InstanceMicroseconds =
+        instanceTimes[jmin(instanceTimes.size() - 1, (size_t)std::ceil(0.99 * (double)instanceTimes.size()) - 1)];
+  }
+  return true;
+}
+
+std::int64_t ScalingBenchmark::getResidentBytes() {
+#if JUCE_LINUX
+  // 2番目の値が常駐ページ数
+  const auto fields = StringArray::fromTokens(File("/proc/self/statm").loadFileAsString(), " ", "");
+  if (fields.size() < 2) {
+    return -1;
+  }
+  return fields[1].getLargeIntValue() * (std::int64_t)sysconf(_SC_PAGESIZE);
+#else
+  return -1;
+#endif
+}
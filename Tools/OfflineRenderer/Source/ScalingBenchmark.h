@@ -0,0 +1,51 @@
+#pragma once
+
+#include "OfflineRenderer.h"
+
+/*
+--------------------------------------------------------------------------------
+ScalingBenchmark
+DAWと同じように, N個のPluginProcessorをM本のホストスレッドで毎サイクル分担して処理する.
+各サイクルではすべてのインスタンスが1ブロックずつ処理し, 全員が終わるまで次のサイクルへ進まない.
+M本にはサイクルを進めるスレッド自身も含み, 他のスレッドは仕事がない間は条件変数で待つ.
+スループット, インスタンスごとの処理時間とメモリ使用量, processBlock中のミューテックスの
+ロック回数/競合回数を計測し, スレッド数を増やしたときにどこで伸びが止まるかを調べる.
+--------------------------------------------------------------------------------
+*/
+struct ScalingSettings {
+  double sampleRate = 48000.0;
+  std::int32_t blockSize = 256;
+  // インスタンス1つあたりに処理する音声の長さ
+  double seconds = 5.0;
+  std::int32_t numInstances = 16;
+  std::int32_t numThreads = 1;
+};
+
+struct ScalingResult {
+  double wallSeconds = 0.0;
+  std::int64_t numCycles = 0;
+  // 全インスタンスの処理した音声の長さ / 経過時間. 実時間で同時に動かせるインスタンス数の目安
+  double realtimeInstances = 0.0;
+  double avgInstanceMicroseconds = 0.0;
+  double p99InstanceMicroseconds = 0.0;
+  double maxCycleMicroseconds = 0.0;
+  // 1サイクルがブロック長の実時間を超えた回数
+  std::int64_t numCycleOverruns = 0;
+  std::int64_t numLocks = 0;
+  std::int64_t numContendedLocks = 0;
+  // 常駐メモリの増加量 / インスタンス数. 取得できなければ負の値
+  double memoryPerInstanceBytes = -1.0;
+};
+
+class ScalingBenchmark {
+ public:
+  explicit ScalingBenchmark(const ScalingSettings& settings);
+
+  bool run(ScalingResult& result, String& error);
+
+ private:
+  // /proc/self/statm から常駐メモリ量を読む. Linux以外では-1
+  static std::int64_t getResidentBytes();
+
+  ScalingSettings settings;
+};
@@ -0,0 +1,122 @@
+#include "SoftClipperCheck.h"
+
+namespace {
+// 解析するFFTの長さは 2^FFT_ORDER
+const int FFT_ORDER = 12;
+const std::int32_t FFT_SIZE = 1 << FFT_ORDER;
+
+// 段階的に上げる周波数. 実際にはビンに乗る奇数番目のビンの周波数を使う
+const double SWEEP_FREQUENCIES[] = {100.0, 300.0, 1000.0, 2000.0, 3000.0, 4500.0, 6000.0,
+                                    8000.0, 10000.0, 12500.0, 15000.0, 18000.0};
+
+// long doubleで計算した原関数. SoftClipper::antiderivativeと同じ式
+long double referenceAntiderivative(long double x) {
+  const auto ax = std::abs(x);
+  const auto xc = ax < 3.0L ? ax : 3.0L;
+  const auto x2 = xc * xc;
+  return x2 / 18.0L + (4.0L / 3.0L) * std::log(x2 + 3.0L) + (ax > 3.0L ? ax - 3.0L : 0.0L);
+}
+
+// 基本波のビンの倍数を高調波, それ以外をエイリアスとして電力比を求める
+double getAliasRatioDb(const std::vector<float>& signal, std::int32_t fundamentalBin) {
+  dsp::FFT fft(FFT_ORDER);
+  std::vector<float> data((size_t)FFT_SIZE * 2, 0.0f);
+  std::copy(signal.end() - FFT_SIZE, signal.end(), data.begin());
+  fft.performFrequencyOnlyForwardTransform(data.data());
+
+  auto harmonicPower = 0.0;
+  auto aliasPower = 0.0;
+  for (auto bin = 1; bin < FFT_SIZE / 2; ++bin) {
+    const auto power = (double)data[(size_t)bin] * (double)data[(size_t)bin];
+    if (bin % fundamentalBin == 0) {
+      harmonicPower += power;
+    } else {
+      aliasPower += power;
+    }
+  }
+  return 10.0 * std::log10(aliasPower / jmax(harmonicPower, 1.0e-30) + 1.0e-30);
+}
+}  // namespace
+
+bool SoftClipperCheckResult::isPadePassed() const {
+  return padeMaxError <= SoftClipperCheck::MAX_PADE_ERROR;
+}
+
+bool SoftClipperCheckResult::isAdaaPassed() const {
+  return adaaMaxError <= SoftClipperCheck::MAX_ADAA_ERROR;
+}
+
+bool SoftClipperCheckResult::isSweepPassed() const {
+  for (const auto& step : sweep) {
+    if (!step.passed) {
+      return false;
+    }
+  }
+  return true;
+}
+
+SoftClipperCheckResult SoftClipperCheck::run() {
+  SoftClipperCheckResult result;
+  result.padeMaxError = measurePadeError();
+  result.adaaMaxError = measureAdaaError();
+  for (const auto frequency : SWEEP_FREQUENCIES) {
+    result.sweep.push_back(measureSweepStep(frequency));
+  }
+  return result;
+}
+
+double SoftClipperCheck::measurePadeError() {
+  auto maxError = 0.0;
+  for (auto i = -60000; i <= 60000; ++i) {
+    const auto x = (float)i * 1.0e-4f;
+    maxError = jmax(maxError, std::abs((double)SoftClipper::clip(x) - std::tanh((double)x)));
+  }
+  return maxError;
+}
+
+double SoftClipperCheck::measureAdaaError() {
+  // 離れた2点と, 差分商の桁落ちが起きやすい近い2点の両方を, 振り切れる範囲も含めて調べる
+  Random random(1);
+  auto maxError = 0.0;
+  for (auto i = 0; i < 1000000; ++i) {
+    const auto x1 = (random.nextFloat() * 2.0f - 1.0f) * 4.0f;
+    const auto x = (i % 2 == 0) ? (random.nextFloat() * 2.0f - 1.0f) * 4.0f
+                                : x1 + (random.nextFloat() * 2.0f - 1.0f) * 1.0e-3f;
+    const auto dx = (long double)x - (long double)x1;
+    if (std::abs(dx) < 1.0e-7L) {
+      continue;
+    }
+    const auto reference = (referenceAntiderivative(x) - referenceAntiderivative(x1)) / dx;
+    maxError = jmax(maxError, (double)std::abs((long double)SoftClipper::differenceQuotient(x, x1) - reference));
+  }
+  return maxError;
+}
+
+SoftClipperSweepStep SoftClipperCheck::measureSweepStep(double targetFrequency) {
+  // 奇数番目のビンにすると, 折り返した成分が高調波のビンに重ならない
+  auto bin = jmax(1, roundToInt(targetFrequency * FFT_SIZE / SAMPLE_RATE));
+  if (bin % 2 == 0) {
+    ++bin;
+  }
+
+  // 前半を捨て, 定常状態の後半を解析する
+  const auto numSamples = FFT_SIZE * 2;
+  std::vector<float> naive((size_t)numSamples);
+  std::vector<float> adaa((size_t)numSamples);
+  for (auto i = 0; i < numSamples; ++i) {
+    const auto x =
+        SWEEP_AMPLITUDE * (float)std::sin(MathConstants<double>::twoPi * bin * (i % FFT_SIZE) / FFT_SIZE);
+    naive[(size_t)i] = SoftClipper::clip(x);
+    adaa[(size_t)i] = x;
+  }
+  SoftClipper clipper;
+  clipper.prepare(1);
+  clipper.processSamples(0, adaa.data(), numSamples);
+
+  SoftClipperSweepStep step;
+  step.frequency = bin * SAMPLE_RATE / FFT_SIZE;
+  step.naiveAliasDb = getAliasRatioDb(naive, bin);
+  step.adaaAliasDb = getAliasRatioDb(adaa, bin);
+  step.passed = step.naiveAliasDb < ALIAS_FLOOR_DB || step.adaaAliasDb <= step.naiveAliasDb - MIN_ALIAS_REDUCTION_DB;
+  return step;
+}
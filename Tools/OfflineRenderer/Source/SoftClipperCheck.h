@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+#include "../../../Source/DSP/SoftClipper.h"
+
+/*
+--------------------------------------------------------------------------------
+SoftClipperCheck
+SoftClipperの精度を確認する.
+  pade    : クリップ関数(パデ近似)とtanhの最大誤差
+  adaa    : floatで計算するADAAの差分商と, long doubleで計算した原関数の差分商の最大誤差
+  sweep   : 周波数を段階的に上げたサインをクリップし, 高調波以外の成分(エイリアス)の電力を
+            サンプルごとにクリップした場合(naive)とADAAで比べる
+周波数はFFTのビンにちょうど乗る奇数番目のビンに揃え, 窓をかけずに定常状態の区間を解析する.
+--------------------------------------------------------------------------------
+*/
+struct SoftClipperSweepStep {
+  double frequency = 0.0;
+  // 高調波の電力に対するエイリアスの電力 [dB]
+  double naiveAliasDb = 0.0;
+  double adaaAliasDb = 0.0;
+  bool passed = false;
+};
+
+struct SoftClipperCheckResult {
+  double padeMaxError = 0.0;
+  double adaaMaxError = 0.0;
+  std::vector<SoftClipperSweepStep> sweep;
+
+  bool isPadePassed() const;
+  bool isAdaaPassed() const;
+  bool isSweepPassed() const;
+};
+
+class SoftClipperCheck {
+ public:
+  static constexpr double SAMPLE_RATE = 48000.0;
+  // 入力の振幅. クリップ関数が張り付く3を超える範囲も通す
+  static constexpr float SWEEP_AMPLITUDE = 4.0f;
+  static constexpr double MAX_PADE_ERROR = 0.03;
+  static constexpr double MAX_ADAA_ERROR = 1.0e-5;
+  // naiveのエイリアスがこれより大きいステップでは, ADAAがMIN_ALIAS_REDUCTION_DB以上小さいこと
+  static constexpr double ALIAS_FLOOR_DB = -100.0;
+  static constexpr double MIN_ALIAS_REDUCTION_DB = 3.0;
+
+  static SoftClipperCheckResult run();
+
+ private:
+  static double measurePadeError();
+  static double measureAdaaError();
+  static SoftClipperSweepStep measureSweepStep(double targetFrequency);
+};
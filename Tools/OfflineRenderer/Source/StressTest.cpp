@@ -0,0 +1,152 @@
+#include "StressTest.h"
+
+namespace {
+// 鳴らし直す和音. ボイス数と同じ数のノートを使う
+const std::int32_t CHORD_NOTES[VOICE_MAX] = {48, 55, 60, 64, 67, 71, 74, 79};
+
+void addChord(MidiBuffer& midiMessages, bool isNoteOn, std::int32_t samplePosition) {
+  for (const auto note : CHORD_NOTES) {
+    midiMessages.addEvent(isNoteOn ? MidiMessage::noteOn(1, note, (uint8)100) : MidiMessage::noteOff(1, note),
+                          samplePosition);
+  }
+}
+}  // namespace
+
+const StringArray& StressTest::getScenarioNames() {
+  static const StringArray names{"all_notes", "retrigger_storm", "voicing_switch", "automation", "combined"};
+  return names;
+}
+
+StressTest::StressTest(const String& s, const StressSettings& st) : scenario(s), settings(st), random(st.seed) {}
+
+bool StressTest::run(BlockTimeStats& stats, String& error) {
+  RenderSettings renderSettings;
+  renderSettings.sampleRate = settings.sampleRate;
+  renderSettings.blockSize = settings.blockSize;
+
+  OfflineRenderer renderer(renderSettings);
+  if (!renderer.prepare(error)) {
+    return false;
+  }
+  auto& processor = renderer.getProcessor();
+
+  AudioBuffer<float> buffer(renderSettings.numChannels, settings.blockSize);
+  MidiBuffer midiMessages;
+  midiMessages.ensureSize(32768);
+
+  const auto totalSamples = (std::int64_t)(settings.seconds * settings.sampleRate);
+  std::vector<double> blockTimes;
+  blockTimes.reserve((size_t)(totalSamples / settings.blockSize + 1));
+
+  for (std::int64_t position = 0; position < totalSamples; position += settings.blockSize) {
+    // ホストのオートメーションと同じく, ブロックの直前にパラメータを変える
+    automate(processor, (std::int64_t)blockTimes.size());
+    // ホストではタイマーから呼ばれる. ここにはメッセージループがないため, ブロックの前に呼ぶ
+    processor.updateEchoBuffers();
+
+    midiMessages.clear();
+    fillMidi(midiMessages, position, settings.blockSize);
+    buffer.clear();
+
+    const auto start = Time::getHighResolutionTicks();
+    processor.processBlock(buffer, midiMessages);
+    blockTimes.push_back(Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start) * 1.0e6);
+  }
+
+  if (blockTimes.empty()) {
+    error = "no blocks rendered";
+    return false;
+  }
+
+  stats.numBlocks = (std::int64_t)blockTimes.size();
+  stats.deadlineMicroseconds = settings.blockSize / settings.sampleRate * 1.0e6;
+
+  auto sum = 0.0;
+  for (const auto time : blockTimes) {
+    sum += time;
+    if (time > stats.deadlineMicroseconds) {
+      ++stats.numOverruns;
+    }
+  }
+  stats.avgMicroseconds = sum / (double)blockTimes.size();
+
+  std::sort(blockTimes.begin(), blockTimes.end());
+  const auto percentile = [&blockTimes](double ratio) {
+    const auto index = (size_t)std::ceil(ratio * (double)blockTimes.size()) - 1;
+    return blockTimes[jmin(index, blockTimes.size() - 1)];
+  };
+  stats.p99Microseconds = percentile(0.99);
+  stats.p999Microseconds = percentile(0.999);
+  stats.maxMicroseconds = blockTimes.back();
+  return true;
+}
+
+void StressTest::fillMidi(MidiBuffer& midiMessages, std::int64_t position, std::int32_t numSamples) {
+  const auto allNotesPeriod = (std::int64_t)settings.sampleRate;
+  const auto stormPeriod = jmax((std::int64_t)1, (std::int64_t)(settings.sampleRate * 0.001));
+  const auto chordPeriod = jmax((std::int64_t)1, (std::int64_t)(settings.sampleRate * 0.05));
+  // 他のシナリオで音が鳴っているように, 和音を50msごとに鳴らし直す
+  const auto needsChord =
+      !isEnabled("retrigger_storm") && (isEnabled("voicing_switch") || isEnabled("automation"));
+
+  for (auto i = 0; i < numSamples; ++i) {
+    const auto samplePosition = position + i;
+
+    if (isEnabled("all_notes")) {
+      if (samplePosition % allNotesPeriod == 0) {
+        for (auto note = 0; note < 128; ++note) {
+          midiMessages.addEvent(MidiMessage::noteOn(1, note, (uint8)100), i);
+        }
+      } else if (samplePosition % allNotesPeriod == allNotesPeriod / 2) {
+        for (auto note = 0; note < 128; ++note) {
+          midiMessages.addEvent(MidiMessage::noteOff(1, note), i);
+        }
+      }
+    }
+
+    if (isEnabled("retrigger_storm") && samplePosition % stormPeriod == 0) {
+      addChord(midiMessages, false, i);
+      addChord(midiMessages, true, i);
+    }
+
+    if (needsChord) {
+      if (samplePosition % chordPeriod == 0) {
+        addChord(midiMessages, true, i);
+      } else if (samplePosition % chordPeriod == chordPeriod * 3 / 4) {
+        addChord(midiMessages, false, i);
+      }
+    }
+  }
+}
+
+void StressTest::automate(PluginProcessor& p, std::int64_t blockIndex) {
+  if (isEnabled("voicing_switch")) {
+    *p.voicingParameters.VoicingSwitch = (int)(blockIndex % NUM_OF_VOICING_TYPES);
+  }
+
+  if (isEnabled("automation")) {
+    *p.chipOscParameters.OscWaveType = random.nextInt(NUM_OF_WAVE_TYPES);
+    *p.chipOscParameters.VolumeLevel = -32.0f + random.nextFloat() * 40.0f;
+    *p.chipOscParameters.ColorType = random.nextInt(NUM_OF_COLOR_TYPES);
+    *p.chipOscParameters.Attack = random.nextFloat() * 0.05f;
+    *p.chipOscParameters.Decay = random.nextFloat() * 0.2f;
+    *p.chipOscParameters.Sustain = random.nextFloat();
+    *p.chipOscParameters.Release = random.nextFloat() * 0.2f;
+    *p.sweepParameters.SweepSwitch = random.nextInt(NUM_OF_SWEEP_TYPES);
+    *p.sweepParameters.SweepTime = 0.01f + random.nextFloat();
+    *p.vibratoParameters.VibratoEnable = random.nextBool();
+    *p.vibratoParameters.VibratoAmount = random.nextFloat() * 12.0f;
+    *p.vibratoParameters.VibratoSpeed = random.nextFloat() * 20.0f;
+    *p.midiEchoParameters.IsEchoEnable = random.nextBool();
+    *p.midiEchoParameters.EchoDuration = 0.01f + random.nextFloat() * 0.5f;
+    *p.midiEchoParameters.EchoRepeat = 1 + random.nextInt(5);
+    *p.wavePatternParameters.PatternEnabled = random.nextBool();
+    *p.filterParameters.HicutEnable = random.nextBool();
+    *p.filterParameters.LowcutEnable = random.nextBool();
+    *p.filterParameters.HicutFreq = 40.0f + random.nextFloat() * 19960.0f;
+    *p.filterParameters.LowcutFreq = 40.0f + random.nextFloat() * 19960.0f;
+    *p.voiceFilterParameters.FilterEnable = random.nextBool();
+    *p.voiceFilterParameters.Cutoff = 40.0f + random.nextFloat() * 19960.0f;
+    *p.voiceFilterParameters.Resonance = 0.1f + random.nextFloat() * 9.9f;
+  }
+}
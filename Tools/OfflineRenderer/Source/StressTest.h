@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+#include "OfflineRenderer.h"
+
+/*
+--------------------------------------------------------------------------------
+StressTest
+最悪の状況を想定したMIDIとパラメータ操作を固定のブロックサイズでprocessBlockへ流し込み,
+ブロックごとの処理時間をそのブロックの締め切り(ブロック長の実時間)と比べる.
+  all_notes       : 128ノートを同時に鳴らし, まとめて離す
+  retrigger_storm : 1msごとに和音を離して鳴らし直す
+  voicing_switch  : 毎ブロック POLY / MONO / PORTAMENTO を切り替える
+  automation      : 毎ブロック主要なパラメータを変更する
+  combined        : 上のすべてを同時に行う
+パラメータの変更はホストと同じくprocessBlockの直前に行い, 処理時間には含めない.
+--------------------------------------------------------------------------------
+*/
+struct StressSettings {
+  double sampleRate = 48000.0;
+  std::int32_t blockSize = 128;
+  double seconds = 10.0;
+  std::int32_t seed = 1;
+};
+
+struct BlockTimeStats {
+  std::int64_t numBlocks = 0;
+  // ブロック長の実時間. これを超えたブロックは音切れになる
+  double deadlineMicroseconds = 0.0;
+  double avgMicroseconds = 0.0;
+  double p99Microseconds = 0.0;
+  double p999Microseconds = 0.0;
+  double maxMicroseconds = 0.0;
+  std::int64_t numOverruns = 0;
+
+  double getLoadPercent(double microseconds) const {
+    return deadlineMicroseconds > 0.0 ? microseconds / deadlineMicroseconds * 100.0 : 0.0;
+  }
+};
+
+class StressTest {
+ public:
+  static const StringArray& getScenarioNames();
+
+  StressTest(const String& scenario, const StressSettings& settings);
+
+  bool run(BlockTimeStats& stats, String& error);
+
+ private:
+  void fillMidi(MidiBuffer& midiMessages, std::int64_t position, std::int32_t numSamples);
+  void automate(PluginProcessor& processor, std::int64_t blockIndex);
+
+  bool isEnabled(const char* name) const { return scenario == name || scenario == "combined"; }
+
+  String scenario;
+  StressSettings settings;
+  Random random;
+};
@@ -0,0 +1,38 @@
+#!/bin/sh
+set -eu
+
+# Records golden reference WAVs with the engine of another revision.
+# usage: record_golden.sh <revision> [output dir] [golden options...]
+#   PROJUCER  path to the Projucer executable (default: Projucer)
+#
+# The revision is checked out in a temporary worktree, so the current tree is not touched.
+# The renderer sources of that revision are used, so it must already contain the golden command.
+# Extra options go to the golden command, e.g. --filter color_user to record only a case added later.
+
+if [ $# -lt 1 ]; then
+    echo "usage: $0 <revision> [output dir] [golden options...]" >&2
+    exit 1
+fi
+
+# variables
+current=$(cd "$(dirname "$0")" && pwd)
+revision=$1
+outputDir=${2:-$current/golden}
+shift $(( $# < 2 ? $# : 2 ))
+projucer=${PROJUCER:-Projucer}
+worktree=$(mktemp -d)
+
+cleanup() {
+    git -C "$current" worktree remove --force "$worktree" 2>/dev/null || rm -rf "$worktree"
+}
+trap cleanup EXIT
+
+# build the offline renderer of the revision
+git -C "$current" worktree add --detach "$worktree" "$revision"
+"$projucer" --resave "$worktree/Tools/OfflineRenderer/OfflineRenderer.jucer"
+make -C "$worktree/Tools/OfflineRenderer/Builds/LinuxMakefile" CONFIG=Release -j"$(nproc)"
+
+# record the references
+mkdir -p "$outputDir"
+"$worktree/Tools/OfflineRenderer/Builds/LinuxMakefile/build/SANA_OfflineRenderer" golden --dir "$outputDir" --record "$@"
+echo "recorded $(git -C "$current" rev-parse --short "$revision") into $outputDir"